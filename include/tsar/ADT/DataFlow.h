@@ -41,12 +41,16 @@
 #ifndef TSAR_DATA_FLOW_H
 #define TSAR_DATA_FLOW_H
 
+#include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/GraphTraits.h>
 #include <llvm/ADT/iterator_range.h>
 #include <llvm/ADT/SmallVector.h>
 #include <llvm/ADT/PostOrderIterator.h>
 #include <algorithm>
+#include <functional>
 #include <iterator>
+#include <queue>
 #include <type_traits>
 #include <vector>
 #include <bcl/utility.h>
@@ -92,6 +96,10 @@ namespace tsar {
 ///     true if produced data-flow value differs from the data-flow value
 ///     produced on previous iteration of the data-flow analysis algorithm.
 ///     For the first iteration the new value compares with the initial one.
+/// - static constexpr bool UseWorklist (optional) -
+///     If it is set to true a worklist-based solver will be used instead of
+///     round-robin iterations to solve data-flow problem for a graph which
+///     contains cycles (see solveDataFlowWorklist()).
 ///
 /// Direction of the data-flow is specified by child_begin and child_end
 /// functions which is defined in the llvm::GraphTraits<GraphType> class.
@@ -170,6 +178,91 @@ template<class DFFwk> void solveDataFlowIteratively(DFFwk DFF,
   } while (isChanged);
 }
 
+/// \brief Solves data-flow problem using a worklist of nodes.
+///
+/// This computes IN and OUT for each node in the specified data-flow graph
+/// by successive approximation similar to solveDataFlowIteratively(). However,
+/// only nodes which inputs have been changed are revisited. Nodes are
+/// extracted from the worklist in reverse post-order (priorities are
+/// calculated once before the data-flow problem is solved), so the number of
+/// evaluations of transfer functions is close to the minimum one.
+/// \param [in, out] DFF Data-flow framework, it can not be null.
+/// \param [in, out] DFG Data-flow graph specified in the data-flow framework.
+/// Subgraph of this graph also can be used.
+/// \attention The DataFlowTraits class should be specialized by DFFwk.
+/// Note that DFFwk is generally a pointer type.
+/// The GraphTraits class should be specialized by
+/// DataFlowTraits<DFFwk>::GraphType and by
+/// llvm::Inverse<DataFlowTraits<DFFwk>::GraphType>.
+/// \pre The graph must not contain unreachable nodes.
+template<class DFFwk> void solveDataFlowWorklist(DFFwk DFF,
+    typename DataFlowTraits<DFFwk>::GraphType DFG) {
+  typedef DataFlowTraits<DFFwk> DFT;
+  typedef typename DFT::ValueType ValueType;
+  typedef typename DFT::GraphType GraphType;
+  typedef llvm::GraphTraits<GraphType> GT;
+  typedef llvm::GraphTraits<llvm::Inverse<GraphType>> InvGT;
+  typedef typename GT::nodes_iterator nodes_iterator;
+  typedef typename GT::ChildIteratorType ChildIteratorType;
+  typedef typename InvGT::ChildIteratorType SuccIteratorType;
+  typedef typename GT::NodeRef NodeRef;
+  typedef llvm::po_iterator<
+    GraphType, llvm::SmallPtrSet<NodeRef, 8>, false, InvGT> po_iterator;
+  // Priority of a node is its number in reverse post-order.
+  std::vector<NodeRef> RPOT;
+  std::copy(po_iterator::begin(DFG), po_iterator::end(DFG),
+            std::back_inserter(RPOT));
+  std::reverse(RPOT.begin(), RPOT.end());
+  llvm::DenseMap<NodeRef, unsigned> Priority;
+  for (unsigned I = 0, EI = RPOT.size(); I < EI; ++I)
+    Priority.try_emplace(RPOT[I], I);
+  auto EntryNode = GT::getEntryNode(DFG);
+  for (nodes_iterator I = GT::nodes_begin(DFG), E = GT::nodes_end(DFG);
+       I != E; ++I) {
+    assert((*I == EntryNode || GT::child_begin(*I) != GT::child_end(*I)) &&
+      "Data-flow graph must not contain unreachable nodes!");
+    DFT::initialize(*I, DFF, DFG);
+    DFT::setValue(DFT::topElement(DFF, DFG), *I, DFF);
+    // Nodes which are not reachable in a post-order traversal are still
+    // processed (with the lowest priority) to obtain the same result as
+    // solveDataFlowIteratively().
+    if (Priority.try_emplace(*I, RPOT.size()).second)
+      RPOT.push_back(*I);
+  }
+  DFT::initialize(EntryNode, DFF, DFG);
+  DFT::setValue(DFT::boundaryCondition(DFF, DFG), EntryNode, DFF);
+  std::priority_queue<unsigned, std::vector<unsigned>, std::greater<unsigned>>
+    Worklist;
+  llvm::BitVector InWorklist(RPOT.size());
+  for (unsigned I = 0, EI = RPOT.size(); I < EI; ++I)
+    if (RPOT[I] != EntryNode) {
+      Worklist.push(I);
+      InWorklist.set(I);
+    }
+  while (!Worklist.empty()) {
+    auto Idx = Worklist.top();
+    Worklist.pop();
+    InWorklist.reset(Idx);
+    auto N = RPOT[Idx];
+    ValueType Value(DFT::topElement(DFF, DFG));
+    for (ChildIteratorType CI = GT::child_begin(N), CE = GT::child_end(N);
+         CI != CE; ++CI)
+      DFT::meetOperator(DFT::getValue(*CI, DFF), Value, DFF, DFG);
+    if (!DFT::transferFunction(std::move(Value), N, DFF, DFG))
+      continue;
+    for (SuccIteratorType SI = InvGT::child_begin(N), SE = InvGT::child_end(N);
+         SI != SE; ++SI) {
+      auto PriorityItr = Priority.find(*SI);
+      // Successors outside the data-flow graph (or subgraph) are ignored.
+      if (PriorityItr == Priority.end() || *SI == EntryNode ||
+          InWorklist.test(PriorityItr->second))
+        continue;
+      Worklist.push(PriorityItr->second);
+      InWorklist.set(PriorityItr->second);
+    }
+  }
+}
+
 /// \brief Solves data-flow problem in topological order during one iteration.
 ///
 /// This computes IN and OUT for each node in the specified data-flow graph
@@ -268,6 +361,16 @@ template<class DFFwk > struct RegionDFTraits {
   typedef typename DFFwk::UnknownFrameworkError GraphType;
 };
 
+namespace detail {
+/// Checks whether DataFlowTraits (DFT) requests a worklist-based solver.
+template<class DFT, class = void>
+struct UseWorklistSolver : std::false_type {};
+
+template<class DFT>
+struct UseWorklistSolver<DFT, std::void_t<decltype(DFT::UseWorklist)>> :
+  std::integral_constant<bool, DFT::UseWorklist> {};
+}
+
 /// \brief Solves data-flow problem for the specified hierarchy of regions.
 ///
 /// The data-flow problems solves upward from innermost regions to the region
@@ -278,7 +381,8 @@ template<class DFFwk > struct RegionDFTraits {
 /// one node which is associated with the whole specified graph. When traversing
 /// from the specified graph to innermost graphs, regions will be consistently
 /// expanded to a data-flow graph. If it is possible the problem will be solved
-/// in topological order in a single pass, otherwise iteratively.
+/// in topological order in a single pass, otherwise iteratively (a worklist
+/// is used if DataFlowTraits<DFFwk>::UseWorklist is set).
 /// \param [in, out] DFF Data-flow framework, it can not be null.
 /// \param [in, out] DFG Data-flow graph specified in the data-flow framework.
 /// Subgraph of this graph also can be used.
@@ -298,6 +402,8 @@ template<class DFFwk> void solveDataFlowUpward(DFFwk DFF,
     solveDataFlowUpward(DFF, *I);
   if (isDAG(DFG))
     solveDataFlowTopologicaly(DFF, DFG);
+  else if constexpr (detail::UseWorklistSolver<DataFlowTraits<DFFwk>>::value)
+    solveDataFlowWorklist(DFF, DFG);
   else
     solveDataFlowIteratively(DFF, DFG);
   RT::collapse(DFF, DFG);
@@ -315,7 +421,8 @@ template<class DFFwk> void solveDataFlowUpward(DFFwk DFF,
 /// a one node in a data-flow graph associated with this region.
 /// The specified graph will be also collapsed
 /// If it is possible the problem will be solved in topological order
-/// in a single pass, otherwise iteratively.
+/// in a single pass, otherwise iteratively (a worklist is used if
+/// DataFlowTraits<DFFwk>::UseWorklist is set).
 /// \param [in, out] DFF Data-flow framework, it can not be null.
 /// \param [in, out] DFG Data-flow graph specified in the data-flow framework.
 /// Subgraph of this graph also can be used.
@@ -332,6 +439,8 @@ template<class DFFwk> void solveDataFlowDownward(DFFwk DFF,
   RT::expand(DFF, DFG);
   if (isDAG(DFG))
     solveDataFlowTopologicaly(DFF, DFG);
+  else if constexpr (detail::UseWorklistSolver<DataFlowTraits<DFFwk>>::value)
+    solveDataFlowWorklist(DFF, DFG);
   else
     solveDataFlowIteratively(DFF, DFG);
   for (region_iterator I = RT::region_begin(DFG), E = RT::region_end(DFG);
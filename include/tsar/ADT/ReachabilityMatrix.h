@@ -0,0 +1,146 @@
+//===- ReachabilityMatrix.h --- Dense Reachability Matrix -------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a dense reachability matrix of a directed graph. Nodes
+// are numbered and a set of nodes reachable from each node is stored as a bit
+// vector, so a single query takes constant time.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TSAR_REACHABILITY_MATRIX_H
+#define TSAR_REACHABILITY_MATRIX_H
+
+#include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/GraphTraits.h>
+#include <llvm/ADT/SCCIterator.h>
+#include <cassert>
+#include <vector>
+
+namespace tsar {
+/// Transitive closure of a directed graph.
+///
+/// A node is reachable from another node if there is a non-empty path between
+/// them, so a node is reachable from itself only if it lies on a cycle.
+/// The closure is built by a single sweep over strongly connected components
+/// of a graph in post-order: all nodes from a component share the same set of
+/// reachable nodes which is a union of sets of its successors.
+///
+/// Nodes which are not reachable from the entry node of a graph are also
+/// numbered. A set of nodes which are reachable from them is evaluated with
+/// a fixed-point iteration.
+template<class GraphType> class ReachabilityMatrix {
+  using GT = llvm::GraphTraits<GraphType>;
+public:
+  using NodeRef = typename GT::NodeRef;
+
+  /// Create an empty matrix, use recalculate() to build it.
+  ReachabilityMatrix() = default;
+
+  /// Build transitive closure of a specified graph.
+  explicit ReachabilityMatrix(const GraphType &G) { recalculate(G); }
+
+  /// Rebuild transitive closure of a specified graph.
+  void recalculate(const GraphType &G) {
+    clear();
+    for (auto N : llvm::nodes(G))
+      mIndex.try_emplace(N, mIndex.size());
+    auto NodesCount{mIndex.size()};
+    mRows.assign(NodesCount, llvm::BitVector(NodesCount));
+    llvm::BitVector Visited(NodesCount);
+    for (auto SCCItr = llvm::scc_begin(G); !SCCItr.isAtEnd(); ++SCCItr) {
+      llvm::BitVector Reachable(NodesCount);
+      for (auto N : *SCCItr)
+        for (auto Succ : llvm::children<NodeRef>(N)) {
+          auto SuccIdx{getIndex(Succ)};
+          Reachable.set(SuccIdx);
+          // Successors from the same component have not been processed yet.
+          if (Visited.test(SuccIdx))
+            Reachable |= mRows[SuccIdx];
+        }
+      for (auto N : *SCCItr) {
+        auto Idx{getIndex(N)};
+        mRows[Idx] = Reachable;
+        Visited.set(Idx);
+      }
+    }
+    if (Visited.count() == NodesCount)
+      return;
+    for (bool Changed = true; Changed;) {
+      Changed = false;
+      for (auto N : llvm::nodes(G)) {
+        auto Idx{getIndex(N)};
+        if (Visited.test(Idx))
+          continue;
+        llvm::BitVector Reachable{mRows[Idx]};
+        for (auto Succ : llvm::children<NodeRef>(N)) {
+          auto SuccIdx{getIndex(Succ)};
+          Reachable.set(SuccIdx);
+          Reachable |= mRows[SuccIdx];
+        }
+        if (Reachable != mRows[Idx]) {
+          mRows[Idx] = std::move(Reachable);
+          Changed = true;
+        }
+      }
+    }
+  }
+
+  /// Release memory.
+  void clear() {
+    mIndex.clear();
+    mRows.clear();
+  }
+
+  /// Return number of nodes in the graph.
+  std::size_t size() const noexcept { return mRows.size(); }
+
+  /// Return true if the matrix has not been built.
+  bool empty() const noexcept { return mRows.empty(); }
+
+  /// Return true if a specified node is numbered.
+  bool contains(NodeRef N) const { return mIndex.count(N); }
+
+  /// Return number of a specified node.
+  unsigned getIndex(NodeRef N) const {
+    auto Itr{mIndex.find(N)};
+    assert(Itr != mIndex.end() && "Node must be numbered!");
+    return Itr->second;
+  }
+
+  /// Return set of numbers of nodes which are reachable from a specified one.
+  const llvm::BitVector &getReachable(NodeRef From) const {
+    return mRows[getIndex(From)];
+  }
+
+  /// Return true if there is a non-empty path from `From` to `To`.
+  bool isReachable(NodeRef From, NodeRef To) const {
+    return getReachable(From).test(getIndex(To));
+  }
+
+  /// Return true if a specified node lies on a cycle.
+  bool isOnCycle(NodeRef N) const { return isReachable(N, N); }
+
+private:
+  llvm::DenseMap<NodeRef, unsigned> mIndex;
+  std::vector<llvm::BitVector> mRows;
+};
+}
+#endif//TSAR_REACHABILITY_MATRIX_H
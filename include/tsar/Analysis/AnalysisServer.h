@@ -199,31 +199,29 @@ class AnalysisResponsePass : public ModulePass, private bcl::Uncopyable {
   };
 
   /// This functor looks up for a provider which allows to access required
-  /// analysis mentioned in AnalysisRequest.
+  /// analysis mentioned in a request.
   ///
   /// If provider is found results of required analysis will be stored in
-  /// analysis response.
+  /// a specified list of analysis.
   struct FindProvider {
-    /// Perform search while response is empty.
+    /// Perform search while list of analysis is empty.
     template <class T> void operator()() {
-      if (Response[tsar::AnalysisResponse::Analysis].empty())
+      if (Analysis.empty())
         processAsProvider<T>(tsar::is_pass_provider<T>());
     }
 
     /// Process `T` as a provider.
     template <class T> void processAsProvider(std::true_type) {
       bool ExistInProvider = true;
-      for (auto &ID : Request[tsar::AnalysisRequest::AnalysisIDs]) {
+      for (auto &ID : IDs) {
         bool E = false;
         tsar::pass_provider_analysis<T>::for_each_type(FindAnalysis{ID, E});
         ExistInProvider &= E;
       }
       if (ExistInProvider) {
         auto &Provider = This->getAnalysis<T>(CloneF);
-        for (auto &ID : Request[tsar::AnalysisRequest::AnalysisIDs]) {
-          Response[tsar::AnalysisResponse::Analysis].push_back(
-              Provider.getWithID(ID));
-        }
+        for (auto &ID : IDs)
+          Analysis.push_back(Provider.getWithID(ID));
         tsar::pass_provider_analysis<T>::for_each_type(
             GetAllFromProvider<T>{Provider, Cache});
       }
@@ -234,17 +232,94 @@ class AnalysisResponsePass : public ModulePass, private bcl::Uncopyable {
 
     AnalysisResponsePass<ResponseT...> *This;
     Function &CloneF;
-    tsar::AnalysisRequest &Request;
-    tsar::AnalysisResponse &Response;
+    llvm::ArrayRef<llvm::AnalysisID> IDs;
+    llvm::SmallVectorImpl<void *> &Analysis;
     AnalysisCache &Cache;
   };
 
+  /// Look up for analysis with specified IDs for a specified function
+  /// (or module-level analysis if `F` is nullptr).
+  ///
+  /// Return false if required analysis are not available, otherwise results
+  /// are stored in `Analysis`. Results which are available for the last
+  /// processed function `ActiveFunc` are cached in `ActiveIDs`.
+  bool findAnalysis(llvm::ValueToValueMapTy &OriginalToClone,
+                    llvm::Function *&ActiveFunc, AnalysisCache &ActiveIDs,
+                    llvm::Function *F, llvm::ArrayRef<llvm::AnalysisID> IDs,
+                    llvm::SmallVectorImpl<void *> &Analysis) {
+    if (!F) {
+      // Use implementation of getAnalysisID() from
+      // llvm/PassAnalysisSupport.h. Pass::getAnalysisID() is a template,
+      // however it does not know a  type of required pass. So, copy body of
+      // getAnalysisID() without type cast.
+      assert(getResolver() &&
+             "Pass has not been inserted into a PassManager object!");
+      for (auto &ID : IDs) {
+        auto ResultPass = getResolver()->findImplPass(ID);
+        assert(ResultPass && "getAnalysis*() called on an analysis that was "
+                             "not 'required' by pass!");
+        Analysis.push_back(ResultPass->getAdjustedAnalysisPointer(ID));
+      }
+      return true;
+    }
+    auto &CloneF = OriginalToClone[F];
+    if (!CloneF)
+      return false;
+    // Check whether we already have required analysis.
+    if (ActiveFunc == &*CloneF) {
+      for (auto ID : IDs) {
+        auto Itr =
+            llvm::find_if(ActiveIDs, [ID](AnalysisCache::value_type &V) {
+              return V.first == ID;
+            });
+        if (Itr == ActiveIDs.end()) {
+          Analysis.clear();
+          ActiveIDs.clear();
+          break;
+        }
+        Analysis.push_back(Itr->second);
+      }
+    } else {
+      ActiveFunc = cast<Function>(CloneF);
+    }
+    if (!Analysis.empty())
+      return true;
+    // If only one function-level analysis is required, then try to find
+    // it in the list of available responses (ResponseT...). Otherwise,
+    // try to find in the list of providers which provides
+    // access to required analysis results.
+    if (IDs.size() == 1) {
+      auto ID = IDs.front();
+      bool E = false;
+      bcl::TypeList<ResponseT...>::for_each_type(FindAnalysis{ID, E});
+      if (E) {
+        auto ResultPass = getResolver()->findImplPass(
+            this, ID, *cast<Function>(CloneF));
+        assert(std::get<Pass *>(ResultPass) && "getAnalysis*() called on "
+          "an analysis that was not 'required' by pass!");
+        Analysis.push_back(
+            std::get<Pass *>(ResultPass)->getAdjustedAnalysisPointer(ID));
+        ActiveIDs.emplace_back(ID, Analysis.back());
+      }
+    }
+    if (Analysis.empty()) {
+      FindProvider FindImpl{this, *cast<Function>(CloneF), IDs, Analysis,
+                            ActiveIDs};
+      bcl::TypeList<ResponseT...>::for_each_type(FindImpl);
+    }
+    return !Analysis.empty();
+  }
+
 public:
   static char ID;
 
   AnalysisResponsePass() : ModulePass(ID) {}
 
   /// Wait for requests in infinite loop. Stop waiting after incorrect request.
+  ///
+  /// Typed requests contain an address of a request (AnalysisMessage) and
+  /// results are stored in the request without serialization. JSON requests
+  /// are used for debugging purposes only.
   bool runOnModule(Module &M) {
     auto &C = getAnalysis<AnalysisConnectionImmutableWrapper>();
     auto &OriginalToClone =
@@ -260,77 +335,29 @@ public:
         WaitForRequest = false;
         return { tsar::AnalysisSocket::Notify };
       }
+      llvm::SmallVector<void *, 8> Analysis;
+      if (auto *Msg = tsar::AnalysisSocket::decodeMessage(Request)) {
+        if (findAnalysis(OriginalToClone, ActiveFunc, ActiveIDs, Msg->F,
+                         Msg->IDs, Analysis) &&
+            Analysis.size() == Msg->Analysis.size()) {
+          llvm::copy(Analysis, Msg->Analysis.begin());
+          Msg->IsFound = true;
+        }
+        return { tsar::AnalysisSocket::Data };
+      }
       ::json::Parser<tsar::AnalysisRequest> Parser(Request);
       tsar::AnalysisRequest R;
       if (!Parser.parse(R)) {
         llvm_unreachable("Unknown request: listen for analysis request!");
         return { tsar::AnalysisSocket::Invalid };
       }
+      if (!findAnalysis(OriginalToClone, ActiveFunc, ActiveIDs,
+                        R[tsar::AnalysisRequest::Function],
+                        R[tsar::AnalysisRequest::AnalysisIDs], Analysis))
+        return { tsar::AnalysisSocket::Data };
       tsar::AnalysisResponse Response;
-      if (auto *F = R[tsar::AnalysisRequest::Function]) {
-        auto &CloneF = OriginalToClone[F];
-        if (!CloneF)
-          return { tsar::AnalysisSocket::Data};
-        // Check whether we already have required analysis.
-        if (ActiveFunc == &*CloneF) {
-          for (auto ID : R[tsar::AnalysisRequest::AnalysisIDs]) {
-            auto Itr =
-                llvm::find_if(ActiveIDs, [ID](AnalysisCache::value_type &V) {
-                  return V.first == ID;
-                });
-            if (Itr == ActiveIDs.end()) {
-              Response[tsar::AnalysisResponse::Analysis].clear();
-              ActiveIDs.clear();
-              break;
-            }
-            Response[tsar::AnalysisResponse::Analysis].push_back(Itr->second);
-          }
-        } else {
-          ActiveFunc = cast<Function>(CloneF);
-        }
-        if (Response[tsar::AnalysisResponse::Analysis].empty()) {
-          // If only one function-level analysis is required, then try to find
-          // it in the list of available responses (ResponseT...). Otherwise,
-          // try to find in the list of providers which provides
-          // access to required analysis results.
-          if (R[tsar::AnalysisRequest::AnalysisIDs].size() == 1) {
-            auto ID = R[tsar::AnalysisRequest::AnalysisIDs].front();
-            bool E = false;
-            bcl::TypeList<ResponseT...>::for_each_type(FindAnalysis{ID, E});
-            if (E) {
-              auto ResultPass = getResolver()->findImplPass(
-                  this, ID, *cast<Function>(CloneF));
-              assert(std::get<Pass *>(ResultPass) && "getAnalysis*() called on "
-                "an analysis that was not 'required' by pass!");
-              Response[tsar::AnalysisResponse::Analysis].push_back(
-                  std::get<Pass *>(ResultPass)->getAdjustedAnalysisPointer(ID));
-              ActiveIDs.emplace_back(
-                  ID, Response[tsar::AnalysisResponse::Analysis].back());
-            }
-          }
-          if (Response[tsar::AnalysisResponse::Analysis].empty()) {
-            FindProvider FindImpl{this, *cast<Function>(CloneF), R, Response,
-                                  ActiveIDs};
-            bcl::TypeList<ResponseT...>::for_each_type(FindImpl);
-            if (Response[tsar::AnalysisResponse::Analysis].empty())
-              return {tsar::AnalysisSocket::Data};
-          }
-        }
-      } else {
-        // Use implementation of getAnalysisID() from
-        // llvm/PassAnalysisSupport.h. Pass::getAnalysisID() is a template,
-        // however it does not know a  type of required pass. So, copy body of
-        // getAnalysisID() without type cast.
-        assert(getResolver() &&
-               "Pass has not been inserted into a PassManager object!");
-        for (auto &ID : R[tsar::AnalysisRequest::AnalysisIDs]) {
-          auto ResultPass = getResolver()->findImplPass(ID);
-          assert(ResultPass && "getAnalysis*() called on an analysis that was "
-                               "not 'required' by pass!");
-          Response[tsar::AnalysisResponse::Analysis].push_back(
-              ResultPass->getAdjustedAnalysisPointer(ID));
-        }
-      }
+      Response[tsar::AnalysisResponse::Analysis].assign(Analysis.begin(),
+                                                        Analysis.end());
       return tsar::AnalysisSocket::Data +
              ::json::Parser<tsar::AnalysisResponse>::unparseAsObject(Response);
     }))
@@ -22,6 +22,12 @@
 // analysis server and to obtain analysis results and to perform synchronization
 // between a client and a server.
 //
+// Client and server run in the same process, so a request is not serialized.
+// Client passes an address of a request (AnalysisMessage) through the socket
+// and server stores results of analysis in the request. JSON representation
+// of requests and responses (AnalysisRequest, AnalysisResponse) is used for
+// debugging purposes only (-analysis-socket-json).
+//
 //===----------------------------------------------------------------------===//
 
 #ifndef TSAR_ANALYSIS_SOCKET_H
@@ -32,7 +38,9 @@
 #include <bcl/cell.h>
 #include <bcl/IntrusiveConnection.h>
 #include <bcl/Json.h>
+#include <llvm/ADT/ArrayRef.h>
 #include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/STLExtras.h>
 #include <llvm/ADT/StringExtras.h>
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Pass.h>
@@ -53,6 +61,21 @@ JSON_OBJECT_BEGIN(AnalysisResponse)
   AnalysisResponse() : JSON_INIT_ROOT {}
 JSON_OBJECT_END(AnalysisResponse)
 
+/// Request to analysis server which is passed without serialization.
+struct AnalysisMessage {
+  /// List of required analysis.
+  llvm::ArrayRef<llvm::AnalysisID> IDs;
+
+  /// Function to analyze or nullptr to access module-level analysis.
+  llvm::Function *F = nullptr;
+
+  /// Results of analysis, this list has the same size as the list of IDs.
+  llvm::MutableArrayRef<void *> Analysis;
+
+  /// This is set by server if all required analysis are available.
+  bool IsFound = false;
+};
+
 /// This class allows to establish connection to analysis server and to obtain
 /// analysis results and perform synchronization between a client and a server.
 class AnalysisSocket final : public SMStringSocketBase<AnalysisSocket> {
@@ -73,16 +96,70 @@ class AnalysisSocket final : public SMStringSocketBase<AnalysisSocket> {
 
     }
     std::size_t &Idx;
-    std::vector<void *> &Analysis;
+    llvm::ArrayRef<void *> Analysis;
     ResultT &Result;
   };
 
+  /// Digits which are used to encode an address of a message, the delimiter
+  /// is not a digit.
+  static constexpr const char *digits() {
+    return "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  }
+
 public:
+  /// Return true if requests should be encoded as JSON strings.
+  static bool isJSONEnabled();
+
+  /// Encode an address of a specified message.
+  ///
+  /// The request contains 6 bits of the address per character, so it fits
+  /// into a small string buffer and no memory is allocated.
+  static std::string encodeMessage(AnalysisMessage &Msg) {
+    std::string Request{Typed};
+    for (auto Addr{reinterpret_cast<std::uintptr_t>(&Msg)}; Addr != 0;
+         Addr >>= 6)
+      Request += digits()[Addr & 63];
+    Request += Delimiter;
+    return Request;
+  }
+
+  /// Decode an address of a message, return nullptr if a specified request
+  /// is not a typed request.
+  static AnalysisMessage *decodeMessage(llvm::StringRef Request) {
+    if (Request.empty() || Request.front() != Typed)
+      return nullptr;
+    Request = Request.drop_front();
+    if (!Request.empty() && Request.back() == Delimiter)
+      Request = Request.drop_back();
+    std::uintptr_t Addr{0};
+    for (auto C : llvm::reverse(Request)) {
+      std::uintptr_t Digit{0};
+      if (C >= 'A' && C <= 'Z')
+        Digit = C - 'A';
+      else if (C >= 'a' && C <= 'z')
+        Digit = C - 'a' + 26;
+      else if (C >= '0' && C <= '9')
+        Digit = C - '0' + 52;
+      else if (C == '+')
+        Digit = 62;
+      else if (C == '/')
+        Digit = 63;
+      else
+        return nullptr;
+      Addr = (Addr << 6) | Digit;
+    }
+    return reinterpret_cast<AnalysisMessage *>(Addr);
+  }
+
   /// Unparse response to a list of analysis passes.
   ///
   /// Response is a string representation of an address which points to an
   /// analysis pass. A `nullptr` could be encoded with empty string.
+  /// If a request is typed, results are already stored in the request, so
+  /// the response contains the message kind only.
   void processResponse(const std::string &Response) const {
+    if (mIsTyped)
+      return;
     llvm::StringRef Json(Response.data() + 1, Response.size() - 2);
     ::json::Parser<AnalysisResponse> Parser(Json.str());
     AnalysisResponse R;
@@ -97,26 +174,7 @@ public:
   llvm::Optional<
     bcl::StaticTypeMap<typename std::add_pointer<AnalysisType>::type...>>
   getAnalysis() {
-    using ResultT =
-        bcl::StaticTypeMap<typename std::add_pointer<AnalysisType>::type...>;
-    AnalysisRequest R;
-    R[AnalysisRequest::Function] = nullptr;
-    bcl::TypeList<AnalysisType...>::for_each_type(PushBackAnalysisID{R});
-    auto Request =
-        ::json::Parser<AnalysisRequest>::unparseAsObject(R) + Delimiter;
-    for (auto &Callback : mReceiveCallbacks)
-      Callback(Request);
-    // Note, that callback run send() in client, so mAnalysisPass is already
-    // set here.
-    assert(mResponseKind == Data && "Unknown response: wait for data!");
-    if (mAnalysis.size() == sizeof...(AnalysisType)) {
-      ResultT Result;
-      std::size_t Idx = 0;
-      bcl::TypeList<AnalysisType...>::for_each_type(
-          InsertAnalysis<ResultT>{Idx, mAnalysis, Result});
-      return Result;
-    }
-    return llvm::None;
+    return getAnalysisImpl<AnalysisType...>(nullptr);
   }
 
   /// Retrieve a specified analysis results from a server.
@@ -124,30 +182,60 @@ public:
   llvm::Optional<
     bcl::StaticTypeMap<typename std::add_pointer<AnalysisType>::type...>>
   getAnalysis(llvm::Function &F) {
+    return getAnalysisImpl<AnalysisType...>(&F);
+  }
+
+private:
+  /// Retrieve a specified analysis results for a specified function or
+  /// module-level analysis if `F` is nullptr.
+  template<class... AnalysisType>
+  llvm::Optional<
+    bcl::StaticTypeMap<typename std::add_pointer<AnalysisType>::type...>>
+  getAnalysisImpl(llvm::Function *F) {
     using ResultT =
         bcl::StaticTypeMap<typename std::add_pointer<AnalysisType>::type...>;
-    AnalysisRequest R;
-    R[AnalysisRequest::Function] = &F;
-    bcl::TypeList<AnalysisType...>::for_each_type(PushBackAnalysisID{R});
-    auto Request =
-        ::json::Parser<AnalysisRequest>::unparseAsObject(R) + Delimiter;
+    if (isJSONEnabled()) {
+      AnalysisRequest R;
+      R[AnalysisRequest::Function] = F;
+      bcl::TypeList<AnalysisType...>::for_each_type(PushBackAnalysisID{R});
+      auto Request =
+          ::json::Parser<AnalysisRequest>::unparseAsObject(R) + Delimiter;
+      for (auto &Callback : mReceiveCallbacks)
+        Callback(Request);
+      // Note, that callback run send() in client, so mAnalysisPass is already
+      // set here.
+      assert(mResponseKind == Data && "Unknown response: wait for data!");
+      if (mAnalysis.size() == sizeof...(AnalysisType)) {
+        ResultT Result;
+        std::size_t Idx = 0;
+        bcl::TypeList<AnalysisType...>::for_each_type(
+            InsertAnalysis<ResultT>{Idx, mAnalysis, Result});
+        return Result;
+      }
+      return llvm::None;
+    }
+    llvm::AnalysisID IDs[] = {&AnalysisType::ID...};
+    void *Analysis[sizeof...(AnalysisType)] = {};
+    AnalysisMessage Msg{IDs, F, Analysis};
+    auto Request{encodeMessage(Msg)};
+    mIsTyped = true;
     for (auto &Callback : mReceiveCallbacks)
       Callback(Request);
-    // Note, that callback run send() in client, so mAnalysisPass is already
-    // set here.
+    mIsTyped = false;
+    // Note, that callback run send() in client, so results are already
+    // stored in the message here.
     assert(mResponseKind == Data && "Unknown response: wait for data!");
-    if (mAnalysis.size() == sizeof...(AnalysisType)) {
-      ResultT Result;
-      std::size_t Idx = 0;
-      bcl::TypeList<AnalysisType...>::for_each_type(
-          InsertAnalysis<ResultT>{Idx, mAnalysis, Result});
-      return Result;
-    }
-    return llvm::None;
+    if (!Msg.IsFound)
+      return llvm::None;
+    ResultT Result;
+    std::size_t Idx = 0;
+    bcl::TypeList<AnalysisType...>::for_each_type(
+        InsertAnalysis<ResultT>{Idx, Analysis, Result});
+    return Result;
   }
 
-private:
   mutable std::vector<void *> mAnalysis;
+  bool mIsTyped = false;
 };
 
 /// This is a container to store sockets.
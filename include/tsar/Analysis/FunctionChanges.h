@@ -0,0 +1,135 @@
+//===- FunctionChanges.h --- Function Change Tracker ------------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a tracker of functions which have been modified by
+// transformation passes between consecutive steps of analysis pipeline.
+// Interprocedural analysis passes may use it to re-analyze modified functions
+// and their callers only and to reuse results for other functions.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TSAR_FUNCTION_CHANGES_H
+#define TSAR_FUNCTION_CHANGES_H
+
+#include "tsar/Support/AnalysisWrapperPass.h"
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/Hashing.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/ValueHandle.h>
+
+namespace llvm {
+class CallGraph;
+class Function;
+class Module;
+}
+
+namespace tsar {
+/// \brief This tracks functions modified between consecutive updates.
+///
+/// A function is modified if its hash differs from the previous one or if it
+/// has been created after the previous update. A function is affected if it is
+/// modified or it transitively calls a modified function. A function which may
+/// call an unknown function (e.g. indirect call) is affected if at least one
+/// function is modified. All functions are modified after the first update.
+///
+/// The hash takes into account operands of instructions and opcode-specific
+/// state (alignment, atomic ordering, indices, etc.), so results of analysis
+/// which refer to IR values may be reused for not affected functions only.
+///
+/// The hash identifies local values by their positions in a function. So,
+/// identities of values in a function body are also checked. A function is
+/// modified if some of its local values or values it refers to have been
+/// deleted or replaced with other values, even if the new body has the same
+/// hash (for example, the body has been rebuilt from scratch).
+class FunctionChangeInfo {
+  /// State of a function after the previous update.
+  struct FunctionState {
+    llvm::WeakVH Function;
+    llvm::hash_code Hash;
+
+    /// Values which identify a body of a function in order of traversal.
+    ///
+    /// Handles become null if values are deleted, so new values are never
+    /// mistaken for the previous ones even if they have the same addresses.
+    llvm::SmallVector<llvm::WeakVH, 0> Values;
+
+    /// Version of the function body, see getVersion().
+    uint64_t Version = 0;
+  };
+
+  using FunctionStateMap =
+      llvm::DenseMap<const llvm::Function *, FunctionState>;
+public:
+  /// Recomputes hashes of all functions in a module and determines modified
+  /// functions.
+  void update(llvm::Module &M, llvm::CallGraph &CG);
+
+  /// Return true if a specified function has been modified.
+  bool isModified(const llvm::Function &F) const {
+    return mModified.count(&F);
+  }
+
+  /// Return true if a specified function or some of its callees
+  /// (transitively) has been modified.
+  bool isAffected(const llvm::Function &F) const {
+    return mAffected.count(&F);
+  }
+
+  /// Return list of functions which have been deleted since the previous
+  /// update.
+  ///
+  /// Note, that pointers are dangling and they should be used to clear
+  /// results of analysis only.
+  llvm::ArrayRef<const llvm::Function *> deleted() const noexcept {
+    return mDeleted;
+  }
+
+  /// Return number of performed updates.
+  unsigned getNumUpdates() const noexcept { return mNumUpdates; }
+
+  /// \brief Return version of a specified function or 0 if the function has
+  /// been created after the last update.
+  ///
+  /// Each modified function gets a new version on update, versions of
+  /// different functions are never equal. So, results of analysis computed for
+  /// a function version may be reused while the version remains the same.
+  /// Note, that modifications are detected on update only.
+  uint64_t getVersion(const llvm::Function &F) const {
+    auto I = mStates.find(&F);
+    return I != mStates.end() && I->second.Function == &F ? I->second.Version
+                                                            : 0;
+  }
+
+private:
+  FunctionStateMap mStates;
+  llvm::SmallPtrSet<const llvm::Function *, 32> mModified;
+  llvm::SmallPtrSet<const llvm::Function *, 32> mAffected;
+  llvm::SmallVector<const llvm::Function *, 8> mDeleted;
+  unsigned mNumUpdates = 0;
+  uint64_t mLastVersion = 0;
+};
+}
+
+namespace llvm {
+/// Wrapper to access functions modified by transformation passes.
+using FunctionChangeWrapper = AnalysisWrapperPass<tsar::FunctionChangeInfo>;
+}
+#endif//TSAR_FUNCTION_CHANGES_H
@@ -367,6 +367,20 @@ public:
         .second;
   }
 
+  /// Returns true if both sets contain the same information.
+  bool operator==(const DefUseSet &RHS) const {
+    return mDefs == RHS.mDefs && mMayDefs == RHS.mMayDefs &&
+           mUses == RHS.mUses && mExplicitAccesses == RHS.mExplicitAccesses &&
+           mAddressAccesses == RHS.mAddressAccesses &&
+           mUnknownInsts == RHS.mUnknownInsts &&
+           mExplicitUnknowns == RHS.mExplicitUnknowns &&
+           mAddressUnknowns == RHS.mAddressUnknowns &&
+           mAddressTransitives == RHS.mAddressTransitives;
+  }
+
+  /// Returns true if sets contain different information.
+  bool operator!=(const DefUseSet &RHS) const { return !operator==(RHS); }
+
 private:
   LocationSet mDefs;
   LocationSet mMayDefs;
@@ -523,6 +537,7 @@ typedef ReachDFFwk::DefinedMemoryInfo DefinedMemoryInfo;
 template<> struct DataFlowTraits<ReachDFFwk *> {
   typedef Forward<DFRegion * > GraphType;
   typedef DefinitionInfo ValueType;
+  static constexpr bool UseWorklist = true;
   static ValueType topElement(ReachDFFwk *, GraphType) {
     DefinitionInfo DI;
     DI.MustReach = LocationDFValue::fullValue();
@@ -64,12 +64,14 @@
 #include <llvm/ADT/DepthFirstIterator.h>
 #include <llvm/ADT/DenseMapInfo.h>
 #include <llvm/ADT/GraphTraits.h>
+#include <llvm/ADT/ilist.h>
 #include <llvm/ADT/iterator.h>
 #include <llvm/ADT/simple_ilist.h>
 #include <llvm/ADT/SmallPtrSet.h>
 #include <llvm/ADT/TinyPtrVector.h>
 #include <llvm/Analysis/AliasAnalysis.h>
 #include <llvm/Pass.h>
+#include <llvm/Support/Allocator.h>
 #include <array>
 #include <iterator>
 #include <tuple>
@@ -948,9 +950,17 @@ class AliasTree {
   /// memory location chains.
   using StrippedMap = llvm::DenseMap<const llvm::Value *, BaseList>;
 
+  /// Alias nodes are allocated in an arena which is owned by the tree, so
+  /// the pool of nodes only destroys a removed node and does not free memory.
+  struct AliasNodePoolTraits : public llvm::ilist_callback_traits<AliasNode> {
+    static void deleteNode(AliasNode *N) { N->~AliasNode(); }
+  };
+
   /// Pool to store pointers to all alias nodes, including forwarding.
-  using AliasNodePool = llvm::ilist<AliasNode,
-    llvm::ilist_tag<Pool>, llvm::ilist_sentinel_tracking<true>>;
+  using AliasNodePool = llvm::iplist_impl<
+    llvm::simple_ilist<AliasNode, llvm::ilist_tag<Pool>,
+      llvm::ilist_sentinel_tracking<true>>,
+    AliasNodePoolTraits>;
 
   /// This is used to iterate over all nodes in tree excluding forwarding.
   template<class ItrTy> class iterator_imp {
@@ -1011,18 +1021,30 @@ public:
   using size_type = AliasNodePool::size_type;
 
   /// Creates empty alias tree.
+  ///
+  /// If `UseArena` is `false` each node and each estimate memory location
+  /// is allocated on the heap separately. This is useful to evaluate
+  /// allocation in arenas only.
   AliasTree(llvm::AAResults &AA,
-      const llvm::DataLayout &DL, const llvm::DominatorTree &DT) :
-    mAA(&AA), mDL(&DL), mDT(&DT), mTopLevelNode(new AliasTopNode) {
+      const llvm::DataLayout &DL, const llvm::DominatorTree &DT,
+      bool UseArena = true) :
+    mAA(&AA), mDL(&DL), mDT(&DT), mUseArena(UseArena),
+    mTopLevelNode(allocate_node<AliasTopNode>()) {
     mNodes.push_back(mTopLevelNode);
   }
 
   /// Destroys alias tree.
+  ///
+  /// If arenas are used, all nodes and estimate memory locations are released
+  /// in bulk when the arenas are destroyed.
   ~AliasTree() {
-    for (auto &Pair : mBases) {
-      for (auto *EM : Pair.second)
-        delete EM;
-    }
+    if (mUseArena)
+      return;
+    for (auto *EM : mHeapMemory)
+      delete EM;
+    mNodes.clear();
+    for (auto *N : mHeapNodes)
+      ::operator delete(N);
   }
 
   /// Returns the underlying alias analysis object used by this tree.
@@ -1158,13 +1180,33 @@ private:
   template<class NodeTy, class CountTy, std::size_t CountNum>
   NodeTy * make_node(
       AliasNode &Parent, std::array<CountTy *, CountNum> Counts) {
-    auto *NewNode = new NodeTy;
+    auto *NewNode = allocate_node<NodeTy>();
     for (auto Count : Counts)
       ++(*Count);
     mNodes.push_back(NewNode);
     NewNode->setParent(Parent, *this);
     return NewNode;
   }
+
+  /// Allocates memory for a new node, the node is not inserted in the tree.
+  template<class NodeTy> NodeTy * allocate_node() {
+    if (mUseArena)
+      return new (mNodeAllocator.Allocate<NodeTy>()) NodeTy;
+    auto *Storage = ::operator new(sizeof(NodeTy));
+    mHeapNodes.push_back(Storage);
+    return new (Storage) NodeTy;
+  }
+
+  /// Allocates memory for a new estimate memory location.
+  template<class... ArgTy> EstimateMemory * make_memory(ArgTy &&... Args) {
+    if (!mUseArena) {
+      mHeapMemory.push_back(new EstimateMemory(std::forward<ArgTy>(Args)...));
+      return mHeapMemory.back();
+    }
+    return new (mMemoryAllocator.Allocate())
+      EstimateMemory(std::forward<ArgTy>(Args)...);
+  }
+
   /// Performs depth-first search of a new node insertion point
   /// and insert a new empty node, if it is necessary.
   ///
@@ -1203,6 +1245,11 @@ private:
   llvm::AAResults *mAA;
   const llvm::DataLayout *mDL;
   const llvm::DominatorTree *mDT;
+  bool mUseArena;
+  llvm::BumpPtrAllocator mNodeAllocator;
+  llvm::SpecificBumpPtrAllocator<EstimateMemory> mMemoryAllocator;
+  std::vector<void *> mHeapNodes;
+  std::vector<EstimateMemory *> mHeapMemory;
   AliasNodePool mNodes;
   AliasNode *mTopLevelNode;
   tsar::AmbiguousRef::AmbiguousPool mAmbiguousPool;
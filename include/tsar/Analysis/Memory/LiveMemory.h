@@ -86,6 +86,7 @@ typedef LiveDFFwk::InterprocLiveMemoryInfo InterprocLiveMemoryInfo;
 template<> struct DataFlowTraits<LiveDFFwk *> {
   typedef Backward<DFRegion * > GraphType;
   typedef MemorySet<MemoryLocationRange> ValueType;
+  static constexpr bool UseWorklist = true;
   static ValueType topElement(LiveDFFwk *, GraphType) { return ValueType(); }
   static ValueType boundaryCondition(LiveDFFwk *DFF, GraphType G) {
     assert(DFF && "Data-flow framework must not be null!");
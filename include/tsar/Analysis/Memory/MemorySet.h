@@ -29,15 +29,27 @@
 #include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/iterator_range.h>
 #include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/STLExtras.h>
 #include <llvm/IR/Metadata.h>
 #include <llvm/IR/Value.h>
 #include <algorithm>
+#include <memory>
 
 namespace tsar {
 /// \brief This implements a set of memory locations.
 ///
 /// Methods of this class do not use alias information. Consequently,
 /// two locations may overlap if they have identical address of beginning.
+///
+/// If there are many locations with the same address of beginning, the
+/// locations are indexed (see MemorySetInfo::getIndexRange()). Locations of
+/// the same shape are sorted by lower bounds of their ranges, so we avoid scan
+/// of the whole list of locations in search of overlapped locations. The index
+/// is built once the number of locations reaches a threshold and it is updated
+/// on each insertion, so const methods do not modify a set and they may be
+/// called concurrently.
+/// \attention Locations must not be updated through iterators, use insert()
+/// to extend locations in a set.
 /// \note This class manages memory allocation to store elements of
 /// a location set.
 template<class LocationTy, class MemoryInfo = MemorySetInfo<LocationTy>>
@@ -47,8 +59,47 @@ class MemorySet {
   /// List of locations.
   using LocationList = llvm::SmallVector<LocationTy, 2>;
 
+  /// Minimum number of locations with the same address of beginning
+  /// which are indexed.
+  static constexpr std::size_t IndexThreshold = 32;
+
+  /// Indexed location.
+  struct IndexEntry {
+    /// Position of a location in a bucket.
+    unsigned Idx;
+
+    /// Range of a location.
+    uint64_t Lower;
+    uint64_t Upper;
+
+    /// Maximum upper bound of this and all previous entries of the same shape.
+    uint64_t MaxUpper;
+  };
+
+  /// Locations of the same shape sorted by lower bounds of their ranges.
+  struct ShapeIndex {
+    std::pair<uint64_t, uint64_t> Shape;
+    llvm::SmallVector<IndexEntry, 32> Sorted;
+  };
+
+  /// Index of locations with the same address of beginning.
+  struct LocationIndex {
+    llvm::SmallVector<ShapeIndex, 2> Shapes;
+
+    /// Positions of locations which cannot be indexed.
+    llvm::SmallVector<unsigned, 4> Other;
+  };
+
+  /// List of locations with the same address of beginning.
+  struct LocationBucket {
+    LocationList Locations;
+
+    /// Index of locations, it is null if there are few locations.
+    std::unique_ptr<LocationIndex> Index;
+  };
+
   /// Map from pointers to locations.
-  using MapTy = llvm::DenseMap<const llvm::Value *, LocationList>;
+  using MapTy = llvm::DenseMap<const llvm::Value *, LocationBucket>;
 public:
   /// \brief Calculate the difference between two sets of locations.
   ///
@@ -91,14 +142,16 @@ public:
       return !operator==(RHS);
     }
 
-    value_type & operator*() const { return mCurItr->second[mIdx]; }
+    value_type & operator*() const {
+      return mCurItr->second.Locations[mIdx];
+    }
 
     value_type * operator->() const { return &operator*(); }
 
     /// Preincrement
     LocationItr & operator++() {
       ++mIdx;
-      if (mCurItr->second.size() == mIdx) {
+      if (mCurItr->second.Locations.size() == mIdx) {
         ++mCurItr;
         mIdx = 0;
       }
@@ -167,9 +220,12 @@ public:
     if (I == mLocations.end())
       return false;
     llvm::SmallVector<Ty, 4> UnionLocs, Tails { Loc };
-    for (auto &Curr : I->second) {
+    // Tails are parts of Loc, so locations which do not overlap Loc
+    // do not change them.
+    forEachOverlapCandidate(I->second, Loc, [&UnionLocs, &Tails](
+        const LocationTy &Curr) {
       if (Tails.empty())
-        break;
+        return false;
       llvm::SmallVector<Ty, 4> NewTails;
       for (auto &Tail : Tails) {
         auto IntOpt = MemoryInfo::intersect(Curr, Tail, nullptr, &NewTails);
@@ -179,7 +235,8 @@ public:
           NewTails.push_back(Tail);
       }
       Tails = std::move(NewTails);
-    }
+      return true;
+    });
     if (Tails.empty())
       Locs.append(UnionLocs.begin(), UnionLocs.end());
     return Tails.empty();
@@ -199,14 +256,16 @@ public:
     if (I == mLocations.end())
       return false;
     bool IsCovered = false;
-    for (auto &Curr : I->second) {
+    forEachOverlapCandidate(I->second, Loc, [&Loc, &Locs, &IsCovered](
+        const LocationTy &Curr) {
       auto IntOpt = MemoryInfo::intersect(Curr, Loc);
       if (IntOpt.hasValue()) {
         IsCovered = true;
         if (MemoryInfo::getPtr(IntOpt.getValue()))
           Locs.push_back(IntOpt.getValue());
       }
-    }
+      return true;
+    });
     return IsCovered;
   }
 
@@ -222,12 +281,9 @@ public:
     auto I = mLocations.find(MemoryInfo::getPtr(Loc));
     if (I == mLocations.end())
       return iterator(mLocations.end(), 0);
-    for (std::size_t Idx = 0, EIdx = I->second.size(); Idx < EIdx; ++Idx) {
-      auto &Curr = I->second[Idx];
-      if (MemoryInfo::hasIntersection(Curr, Loc))
-        return iterator(I, Idx);
-    }
-    return iterator(mLocations.end(), 0);
+    auto Idx = findOverlappedIdx(I->second, Loc);
+    return Idx == I->second.Locations.size() ? iterator(mLocations.end(), 0) :
+      iterator(I, Idx);
   }
 
   /// Return location which may overlap with a specified location.
@@ -235,12 +291,9 @@ public:
     auto I = mLocations.find(MemoryInfo::getPtr(Loc));
     if (I == mLocations.end())
       return const_iterator(mLocations.end(), 0);
-    for (std::size_t Idx = 0, EIdx = I->second.size(); Idx < EIdx; ++Idx) {
-      auto &Curr = I->second[Idx];
-      if (MemoryInfo::hasIntersection(Curr, Loc))
-        return const_iterator(I, Idx);
-    }
-    return const_iterator(mLocations.end(), 0);
+    auto Idx = findOverlappedIdx(I->second, Loc);
+    return Idx == I->second.Locations.size() ?
+      const_iterator(mLocations.end(), 0) : const_iterator(I, Idx);
   }
 
   /// Subtracts locations of this set from the specified location and puts
@@ -253,8 +306,8 @@ public:
       return false;
     bool Intersected = false;
     LocationList LocsToSub { Loc };
-    for (std::size_t Idx = 0, EIdx = I->second.size(); Idx < EIdx; ++Idx) {
-      auto &Curr = I->second[Idx];
+    forEachOverlapCandidate(I->second, Loc, [&LocsToSub, &Intersected](
+        const auto &Curr) {
       LocationList NewLocsToSub;
       for (auto &LocToSub : LocsToSub) {
         auto IntOpt = MemoryInfo::intersect(Curr, LocToSub, nullptr,
@@ -265,7 +318,8 @@ public:
           NewLocsToSub.push_back(LocToSub);
       }
       LocsToSub = std::move(NewLocsToSub);
-    }
+      return true;
+    });
     Locs = std::move(LocsToSub);
     return Intersected;
   }
@@ -296,37 +350,59 @@ public:
     if (I == mLocations.end()) {
       auto Pair = mLocations.try_emplace(MemoryInfo::getPtr(Loc));
       auto NewLoc = MemoryInfo::make(Loc);
-      Pair.first->second.push_back(std::move(NewLoc));
+      Pair.first->second.Locations.push_back(std::move(NewLoc));
       return std::make_pair(iterator(Pair.first, 0), true);
     }
-    std::size_t Idx = 0;
-    auto InsertItr = I->second.begin();
-    for (auto EIdx = I->second.size(); Idx < EIdx; ++Idx) {
-      auto &Curr = I->second[Idx];
-      if (MemoryInfo::areJoinable(Curr, Loc)) {
-        bool isChanged = true;
-        if (MemoryInfo::getAATags(Curr) != MemoryInfo::getAATags(Loc))
-          if (MemoryInfo::getAATags(Curr) ==
-              llvm::DenseMapInfo<llvm::AAMDNodes>::getEmptyKey())
-            MemoryInfo::setAATags(MemoryInfo::getAATags(Loc), Curr);
-          else
-            MemoryInfo::setAATags(
-              llvm::DenseMapInfo<llvm::AAMDNodes>::getTombstoneKey(), Curr);
+    auto &Bucket = I->second;
+    auto &Locations = Bucket.Locations;
+    std::size_t Idx = Locations.size();
+    forEachJoinCandidate(Bucket, Loc, [&Locations, &Loc, &Idx](
+        const LocationTy &Curr) {
+      if (!MemoryInfo::areJoinable(Curr, Loc))
+        return true;
+      Idx = &Curr - Locations.begin();
+      return false;
+    });
+    if (Idx != Locations.size()) {
+      auto &Curr = Locations[Idx];
+      bool isChanged = true;
+      if (MemoryInfo::getAATags(Curr) != MemoryInfo::getAATags(Loc))
+        if (MemoryInfo::getAATags(Curr) ==
+            llvm::DenseMapInfo<llvm::AAMDNodes>::getEmptyKey())
+          MemoryInfo::setAATags(MemoryInfo::getAATags(Loc), Curr);
         else
-          isChanged = false;
-        isChanged = MemoryInfo::join(Loc, Curr);
-        return std::make_pair(iterator(I, Idx), isChanged);
+          MemoryInfo::setAATags(
+            llvm::DenseMapInfo<llvm::AAMDNodes>::getTombstoneKey(), Curr);
+      else
+        isChanged = false;
+      llvm::Optional<MemoryIndexRange> PrevRange;
+      if (Bucket.Index)
+        PrevRange = MemoryInfo::getIndexRange(Curr);
+      isChanged = MemoryInfo::join(Loc, Curr);
+      if (Bucket.Index && isChanged) {
+        eraseFromIndex(*Bucket.Index, Idx, PrevRange);
+        addToIndex(*Bucket.Index, Idx, Curr);
       }
-      if (MemoryInfo::getNumDims(Loc) == 0 &&
-          MemoryInfo::getNumDims(*InsertItr) == 0 &&
-          MemoryInfo::sizecmp(
-              MemoryInfo::getLowerBound(*InsertItr),
-              MemoryInfo::getLowerBound(Loc)) <= 0)
-        ++InsertItr;
+      return std::make_pair(iterator(I, Idx), isChanged);
+    }
+    auto InsertItr = Locations.end();
+    if (MemoryInfo::getNumDims(Loc) == 0)
+      InsertItr = llvm::find_if(Locations, [&Loc](const LocationTy &Curr) {
+        return MemoryInfo::getNumDims(Curr) != 0 ||
+               MemoryInfo::sizecmp(MemoryInfo::getLowerBound(Curr),
+                                   MemoryInfo::getLowerBound(Loc)) > 0;
+      });
+    Idx = InsertItr - Locations.begin();
+    Locations.insert(InsertItr, Loc);
+    if (Bucket.Index) {
+      shiftIndex(*Bucket.Index, Idx);
+      addToIndex(*Bucket.Index, Idx, Locations[Idx]);
+    } else if (Locations.size() >= IndexThreshold) {
+      Bucket.Index = std::make_unique<LocationIndex>();
+      for (unsigned LocIdx = 0, EIdx = Locations.size(); LocIdx < EIdx;
+           ++LocIdx)
+        addToIndex(*Bucket.Index, LocIdx, Locations[LocIdx]);
     }
-    if (MemoryInfo::getNumDims(Loc) > 0)
-      InsertItr = I->second.end();
-    I->second.insert(InsertItr, Loc);
     return std::make_pair(iterator(I, Idx), true);
   }
 
@@ -349,7 +425,7 @@ public:
     mLocations.swap(PrevLocations);
     bool IsChanged = false;
     for (auto &Pair : PrevLocations) {
-      for (auto &Loc : Pair.second) {
+      for (auto &Loc : Pair.second.Locations) {
         if (With.contain(Loc)) {
           insert(Loc);
           continue;
@@ -369,7 +445,7 @@ public:
       return false;
     bool IsChanged = false;
     for (auto &Pair : With.mLocations)
-      for (auto &Loc : Pair.second)
+      for (auto &Loc : Pair.second.Locations)
         IsChanged |= insert(Loc).second;
     return IsChanged;
   }
@@ -389,13 +465,15 @@ public:
       bool HasExactIntersection = false;
       if (auto Itr{mLocations.find(MemoryInfo::getPtr(OtherLoc))};
           Itr != mLocations.end()) {
-        for (auto &Loc : Itr->second) {
+        forEachOverlapCandidate(Itr->second, OtherLoc,
+            [&OtherLoc, &HasExactIntersection](const LocationTy &Loc) {
           auto IntOpt = MemoryInfo::intersect(Loc, OtherLoc);
           if (IntOpt.hasValue() && MemoryInfo::getPtr(IntOpt.getValue())) {
             HasExactIntersection = true;
-            break;
+            return false;
           }
-        }
+          return true;
+        });
       }
       if (!HasExactIntersection) {
         NewLocs.push_back(Pair.first);
@@ -445,14 +523,187 @@ public:
       if (I == RHS.mLocations.end())
         return false;
       LocationList LHSSet, RHSSet;
-      sanitize(Pair.second.begin(), Pair.second.end(), LHSSet);
-      sanitize(I->second.begin(), I->second.end(), RHSSet);
+      sanitize(Pair.second.Locations.begin(), Pair.second.Locations.end(),
+               LHSSet);
+      sanitize(I->second.Locations.begin(), I->second.Locations.end(),
+               RHSSet);
       if (LHSSet != RHSSet)
         return false;
     }
     return true;
   }
 private:
+  /// Return index of locations of a specified shape, create it if it does not
+  /// exist.
+  static ShapeIndex & getShapeIndex(LocationIndex &Index,
+      const std::pair<uint64_t, uint64_t> &Shape) {
+    auto ShapeItr = llvm::find_if(Index.Shapes,
+      [&Shape](const ShapeIndex &S) { return S.Shape == Shape; });
+    if (ShapeItr != Index.Shapes.end())
+      return *ShapeItr;
+    Index.Shapes.emplace_back();
+    Index.Shapes.back().Shape = Shape;
+    return Index.Shapes.back();
+  }
+
+  /// Recompute maximum upper bounds of entries starting from a specified
+  /// position.
+  static void updateMaxUpper(ShapeIndex &S, std::size_t Pos) {
+    uint64_t MaxUpper = Pos > 0 ? S.Sorted[Pos - 1].MaxUpper : 0;
+    for (auto StartPos = Pos, EPos = S.Sorted.size(); Pos < EPos; ++Pos) {
+      MaxUpper = std::max(MaxUpper, S.Sorted[Pos].Upper);
+      // Maximum upper bounds of the following entries do not change.
+      if (Pos != StartPos && S.Sorted[Pos].MaxUpper == MaxUpper)
+        return;
+      S.Sorted[Pos].MaxUpper = MaxUpper;
+    }
+  }
+
+  /// Add location at a specified position in a bucket to the index.
+  static void addToIndex(LocationIndex &Index, unsigned Idx,
+      const LocationTy &Loc) {
+    auto Range = MemoryInfo::getIndexRange(Loc);
+    if (!Range) {
+      Index.Other.push_back(Idx);
+      return;
+    }
+    auto &S = getShapeIndex(Index, Range->Shape);
+    auto Pos = llvm::partition_point(S.Sorted,
+      [&Range](const IndexEntry &E) { return E.Lower <= Range->Lower; }) -
+      S.Sorted.begin();
+    S.Sorted.insert(S.Sorted.begin() + Pos,
+      IndexEntry{Idx, Range->Lower, Range->Upper, 0});
+    updateMaxUpper(S, Pos);
+  }
+
+  /// Remove location at a specified position in a bucket from the index,
+  /// `Range` is the range of the location which has been added to the index.
+  static void eraseFromIndex(LocationIndex &Index, unsigned Idx,
+      const llvm::Optional<MemoryIndexRange> &Range) {
+    if (!Range) {
+      Index.Other.erase(llvm::find(Index.Other, Idx));
+      return;
+    }
+    auto &S = getShapeIndex(Index, Range->Shape);
+    auto EntryItr = std::find_if(
+      llvm::partition_point(S.Sorted, [&Range](const IndexEntry &E) {
+        return E.Lower < Range->Lower;
+      }), S.Sorted.end(), [Idx](const IndexEntry &E) { return E.Idx == Idx; });
+    assert(EntryItr != S.Sorted.end() && "Location must be indexed!");
+    auto Pos = EntryItr - S.Sorted.begin();
+    S.Sorted.erase(EntryItr);
+    updateMaxUpper(S, Pos);
+  }
+
+  /// Increment positions of indexed locations which are not less than `Idx`.
+  static void shiftIndex(LocationIndex &Index, unsigned Idx) {
+    for (auto &Other : Index.Other)
+      if (Other >= Idx)
+        ++Other;
+    for (auto &S : Index.Shapes)
+      for (auto &E : S.Sorted)
+        if (E.Idx >= Idx)
+          ++E.Idx;
+  }
+
+  /// Call a specified function for locations in order of their positions in
+  /// a bucket. Iteration stops if the function returns `false`.
+  ///
+  /// If `Range` is specified, locations of the same shape which ranges do not
+  /// intersect `Range` are skipped. If `IsAdjoinIncluded` is set, locations
+  /// which ranges adjoin `Range` are not skipped.
+  template<class FunctionT>
+  static void forEachIndexed(const LocationBucket &Bucket,
+      const llvm::Optional<MemoryIndexRange> &Range, bool IsAdjoinIncluded,
+      FunctionT &&F) {
+    auto &Locations = Bucket.Locations;
+    if (!Range) {
+      for (auto &Curr : Locations)
+        if (!F(Curr))
+          return;
+      return;
+    }
+    assert(Bucket.Index && "Index must be built!");
+    auto &Index = *Bucket.Index;
+    llvm::SmallVector<unsigned, 8> Candidates(
+      Index.Other.begin(), Index.Other.end());
+    for (auto &S : Index.Shapes) {
+      if (S.Shape != Range->Shape) {
+        for (auto &E : S.Sorted)
+          Candidates.push_back(E.Idx);
+        continue;
+      }
+      // Locations which start after the end of `Range` do not overlap it.
+      auto Pos = llvm::partition_point(S.Sorted,
+        [&Range, IsAdjoinIncluded](const IndexEntry &E) {
+          return E.Lower < Range->Upper ||
+                 (IsAdjoinIncluded && E.Lower == Range->Upper);
+        }) - S.Sorted.begin();
+      auto isBefore = [&Range, IsAdjoinIncluded](uint64_t Upper) {
+        return Upper < Range->Lower ||
+               (!IsAdjoinIncluded && Upper == Range->Lower);
+      };
+      for (; Pos > 0 && !isBefore(S.Sorted[Pos - 1].MaxUpper); --Pos)
+        if (!isBefore(S.Sorted[Pos - 1].Upper))
+          Candidates.push_back(S.Sorted[Pos - 1].Idx);
+    }
+    llvm::sort(Candidates);
+    for (auto Idx : Candidates)
+      if (!F(Locations[Idx]))
+        return;
+  }
+
+  /// Call a specified function for locations which may overlap a specified
+  /// location `Loc` in order of their positions in a bucket. Iteration stops
+  /// if the function returns `false`.
+  ///
+  /// Locations of the same shape as `Loc` which are known not to overlap `Loc`
+  /// are skipped. Note, that all locations are visited if the bucket is small
+  /// or `Loc` cannot be indexed.
+  template<class Ty, class FunctionT>
+  static void forEachOverlapCandidate(const LocationBucket &Bucket,
+      const Ty &Loc, FunctionT &&F) {
+    llvm::Optional<MemoryIndexRange> Range;
+    if (Bucket.Index)
+      Range = MemoryInfo::getIndexRange(Loc);
+    forEachIndexed(Bucket, Range, false, std::forward<FunctionT>(F));
+  }
+
+  /// Call a specified function for locations which may be joined with
+  /// a specified location `Loc` in order of their positions in a bucket.
+  /// Iteration stops if the function returns `false`.
+  ///
+  /// Only locations of the zero shape are skipped, because other locations
+  /// may be joined even if there is a gap between their ranges (for example,
+  /// collapsed locations with a step greater than 1).
+  template<class Ty, class FunctionT>
+  static void forEachJoinCandidate(const LocationBucket &Bucket,
+      const Ty &Loc, FunctionT &&F) {
+    llvm::Optional<MemoryIndexRange> Range;
+    if (Bucket.Index)
+      Range = MemoryInfo::getIndexRange(Loc);
+    if (Range && Range->Shape != std::pair<uint64_t, uint64_t>(0, 0))
+      Range = llvm::None;
+    forEachIndexed(Bucket, Range, true, std::forward<FunctionT>(F));
+  }
+
+  /// Return position of the first location in a bucket which may overlap
+  /// a specified location or size of the bucket if there is no such location.
+  template<class Ty>
+  static std::size_t findOverlappedIdx(const LocationBucket &Bucket,
+      const Ty &Loc) {
+    auto &Locations = Bucket.Locations;
+    std::size_t Idx = Locations.size();
+    forEachOverlapCandidate(Bucket, Loc, [&Locations, &Loc, &Idx](
+        const LocationTy &Curr) {
+      if (!MemoryInfo::hasIntersection(Curr, Loc))
+        return true;
+      Idx = &Curr - Locations.begin();
+      return false;
+    });
+    return Idx;
+  }
+
   template<class SizeT>
   static const SizeT & max(const SizeT &L, const SizeT &R) {
     if (MemoryInfo::sizecmp(L, R) < 0)
@@ -28,6 +28,26 @@
 #include "tsar/Analysis/Memory/MemoryLocationRange.h"
 
 namespace tsar {
+/// Range of a memory location in an index of locations with the same address
+/// of beginning.
+///
+/// Two locations of the same shape have an intersection only if their
+/// ranges overlap. Locations of different shapes are not compared.
+struct MemoryIndexRange {
+  /// Shape of a location, for example, a number of dimensions and a size of
+  /// the first dimension of a collapsed location.
+  ///
+  /// Two locations of the zero shape {0, 0} can be joined only if their
+  /// ranges overlap or adjoin.
+  std::pair<uint64_t, uint64_t> Shape;
+
+  /// Lower bound of a range (inclusive).
+  uint64_t Lower;
+
+  /// Upper bound of a range (exclusive).
+  uint64_t Upper;
+};
+
 /// Provide traits for objects stored in a MemorySet.
 ///
 /// Each object in a set is a memory location which starts and ends at specified
@@ -64,6 +84,10 @@ namespace tsar {
 ///     Join `What` location to `To` if they are joinable.
 /// - static inline bool hasIntersection(const LocationTy &, const LocationTy &)
 ///     Return `true` if locations have an intersection, `false` otherwise.
+/// - static inline llvm::Optional<MemoryIndexRange> getIndexRange(
+///       const LocationTy &)
+///     Return a range which is used to index a location or `None` if
+///     a location cannot be indexed (see MemoryIndexRange).
 /// - static inline llvm::Optional<LocationTy> intersect(
 ///       const LocationTy &A, const LocationTy &B,
 ///       llvm::SmallVectorImpl<LocationTy> *L,
@@ -163,6 +187,10 @@ template<> struct MemorySetInfo<llvm::MemoryLocation> {
     return sizecmp(getUpperBound(LHS), getLowerBound(RHS)) > 0 &&
            sizecmp(getLowerBound(LHS), getUpperBound(RHS)) < 0;
   }
+  static inline llvm::Optional<MemoryIndexRange> getIndexRange(
+      const llvm::MemoryLocation &Loc) {
+    return llvm::None;
+  }
   static inline llvm::Optional<llvm::MemoryLocation> intersect(
       const llvm::MemoryLocation &LHS,
       const llvm::MemoryLocation &RHS,
@@ -290,6 +318,24 @@ template<> struct MemorySetInfo<MemoryLocationRange> {
       const MemoryLocationRange &RHS) {
     return tsar::intersect(LHS, RHS).hasValue();
   }
+  static inline llvm::Optional<MemoryIndexRange> getIndexRange(
+      const MemoryLocationRange &Loc) {
+    if (!(Loc.Kind & MemoryLocationRange::LocKind::Collapsed)) {
+      if (!Loc.DimList.empty() || !Loc.LowerBound.hasValue() ||
+          !Loc.UpperBound.hasValue())
+        return llvm::None;
+      return MemoryIndexRange{{0, 0}, Loc.LowerBound.getValue(),
+                              Loc.UpperBound.getValue()};
+    }
+    // Collapsed locations with the same number of dimensions and the same
+    // size of the first dimension do not intersect if their first dimensions
+    // do not overlap (see tsar::intersect()).
+    if (Loc.DimList.empty() || Loc.DimList.front().TripCount == 0)
+      return llvm::None;
+    auto &Dim = Loc.DimList.front();
+    return MemoryIndexRange{{Loc.DimList.size(), Dim.DimSize}, Dim.Start,
+                            Dim.Start + Dim.Step * (Dim.TripCount - 1) + 1};
+  }
   static inline llvm::Optional<MemoryLocationRange> intersect(
       const MemoryLocationRange &LHS,
       const MemoryLocationRange &RHS,
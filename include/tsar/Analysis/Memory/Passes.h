@@ -218,6 +218,14 @@ void initializeAllocasAAWrapperPassPass(PassRegistry &Regitsry);
 /// Create a pass to access alias results for allocas.
 ImmutablePass *createAllocasAAWrapperPass();
 
+/// Initialize a pass to access results of Andersen's alias analysis for
+/// functions where cheaper analyses are not sufficient.
+void initializeTieredAAWrapperPassPass(PassRegistry &Registry);
+
+/// Create a pass to access results of Andersen's alias analysis for
+/// functions where cheaper analyses are not sufficient.
+ImmutablePass *createTieredAAWrapperPass();
+
 // Initialize a pass to store explicit accesses to global values in a function.
 void initializeGlobalsAccessStoragePass(PassRegistry &Registry);
 
@@ -42,6 +42,7 @@
 #include <llvm/Analysis/MemoryLocation.h>
 #include <llvm/Pass.h>
 #include <forward_list>
+#include <mutex>
 #include <tuple>
 
 namespace tsar {
@@ -164,6 +165,9 @@ public:
 
   /// Recognizes private (last private) variables for loops
   /// in the specified function.
+  ///
+  /// Independent loop nests are analyzed in parallel if -private-jobs option
+  /// is specified.
   /// \pre A control-flow graph of the specified function must not contain
   /// unreachable nodes.
   bool runOnFunction(Function &F) override;
@@ -190,9 +194,16 @@ public:
 private:
   /// Uses dependence analysis pass to collect loop-carried dependencies in
   /// a specified loop.
+  ///
+  /// Pairs of memory accesses are collected once for the outermost loop in
+  /// a nest and are projected onto inner loops.
   void collectDependencies(Loop *L, DependenceMap &Deps,
     tsar::detail::DependenceCache &Cache);
 
+  /// Enumerate pairs of memory accesses in a specified loop and evaluate
+  /// loop-independent results of alias and dependence analysis for them.
+  void collectAccessPairs(Loop *L, tsar::detail::DependenceCache &Cache);
+
   /// Update collection `Deps` of loop-carried dependencies in a specified loop.
   void insertDependence(const Dependence &Dep,
     const MemoryLocation &Src, const MemoryLocation Dst,
@@ -216,6 +227,23 @@ private:
     const tsar::AliasTreeRelation &AliasSTR, tsar::DFRegion *R,
     tsar::detail::DependenceCache &Cache);
 
+  /// Collect outermost loops in a specified region.
+  static void collectLoopNests(tsar::DFRegion *R,
+    SmallVectorImpl<tsar::DFRegion *> &Nests);
+
+  /// Allocate results for all loops in a specified region.
+  static void reserveResults(tsar::DFRegion *R, tsar::PrivateInfo &Info);
+
+  /// Remove forwarding nodes from all paths in the alias tree, so alias tree
+  /// is not lazily updated when it is accessed.
+  static void settleAliasTree(const tsar::AliasTree &AT);
+
+  /// Return estimate memory location which contains a specified location.
+  ///
+  /// Search in the alias tree uses alias analysis and updates search cache,
+  /// so it is guarded by mSharedAnalysisLock.
+  const tsar::EstimateMemory * findMemory(const MemoryLocation &Loc);
+
   /// Set HeaderAccess trait for memory locations explicitly accessed in a
   /// loop header.
   void collectHeaderAccesses(Loop *L, const tsar::DefUseSet &DefUse,
@@ -357,6 +385,11 @@ private:
   const DataLayout *mDL = nullptr;
   TargetLibraryInfo *mTLI = nullptr;
   ScalarEvolution *mSE = nullptr;
+
+  /// Guard for analyses which are shared between loop nests but which are not
+  /// thread-safe (alias tree search, alias and dependence analysis and scalar
+  /// evolution). Only queries to these analyses are guarded.
+  std::mutex mSharedAnalysisLock;
 };
 }
 #endif//TSAR_PRIVATE_ANALYSIS_H
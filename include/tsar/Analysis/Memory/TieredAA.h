@@ -0,0 +1,83 @@
+//===- TieredAA.h --- Tiered Alias Analysis ---------------------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements an alias analysis which uses expensive Andersen's
+// analysis only for functions where cheaper analyses are not sufficient.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TSAR_TIERED_AA_H
+#define TSAR_TIERED_AA_H
+
+#include "tsar/Analysis/Memory/Passes.h"
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Analysis/AliasAnalysis.h>
+#include <llvm/Analysis/CFLAndersAliasAnalysis.h>
+
+namespace llvm {
+/// An alias result set which forwards queries to Andersen's analysis for
+/// escalated functions only.
+///
+/// This analysis should be the last one in the list of alias analyses, so it
+/// is queried only if cheaper analyses are not able to resolve a query.
+/// Graph for Andersen's analysis is built for a function only when the
+/// function is escalated explicitly (if aliasing prevents parallelization of
+/// some loop in this function).
+class TieredAAResult : public AAResultBase<TieredAAResult> {
+public:
+  explicit TieredAAResult(
+      std::function<const TargetLibraryInfo &(Function &F)> GetTLI)
+      : mAnders(std::move(GetTLI)) {}
+
+  AliasResult alias(const MemoryLocation &LocA, const MemoryLocation &LocB,
+                    AAQueryInfo &AAQI);
+
+  /// Use Andersen's analysis for a specified function in subsequent queries.
+  void escalate(const Function &F);
+
+  /// Return true if Andersen's analysis is used for a specified function.
+  bool isEscalated(const Function &F) const { return mEscalated.count(&F); }
+
+private:
+  CFLAndersAAResult mAnders;
+  DenseSet<const Function *> mEscalated;
+};
+
+/// Analysis pass that provides the TieredAAResult object.
+class TieredAAWrapperPass : public ImmutablePass {
+public:
+  static char ID;
+
+  explicit TieredAAWrapperPass() : ImmutablePass(ID) {
+    initializeTieredAAWrapperPassPass(*PassRegistry::getPassRegistry());
+  }
+
+  TieredAAResult &getResult() { return *mResult; }
+  const TieredAAResult &getResult() const { return *mResult; }
+
+  void initializePass() override;
+  bool doFinalization(Module &M) override;
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+
+private:
+  std::unique_ptr<TieredAAResult> mResult;
+};
+}
+#endif//TSAR_TIERED_AA_H
@@ -10,6 +10,7 @@
 #include "tsar/Analysis/Memory/MemoryAccessUtils.h"
 #include "tsar/Analysis/Clang/SourceCFG.h"
 #include "tsar/Analysis/Passes.h"
+#include "tsar/Analysis/Reachability.h"
 #include <llvm/ADT/DirectedGraph.h>
 #include <llvm/ADT/GraphTraits.h>
 #include <llvm/Analysis/LoopInfo.h>
@@ -428,7 +429,8 @@ public:
   PDGBuilder(ProgramDependencyGraph &G, const llvm::Function &F,
     llvm::DependenceInfo &DI, const AliasTree &AT,
     DIMemoryClientServerInfo &DIMInfo, const llvm::TargetLibraryInfo &TLI,
-    const llvm::LoopInfo &LI, bool SolveReachability=true,
+    const llvm::LoopInfo &LI,
+    const BasicBlockReachability *Reachability=nullptr,
     bool Simplify=false, bool CreatePiBlocks=false);
   ~PDGBuilder() = default;
 
@@ -447,40 +449,12 @@ public:
     return I.isDebugOrPseudoInst() || I.isLifetimeStartOrEnd();
   }
 private:
-  struct ReachabilityMatrix : public std::vector<bool> {
-    size_t NodesCount;
-    ReachabilityMatrix() = default;
-    ReachabilityMatrix(size_t _NodesCount)
-      : std::vector<bool>(_NodesCount*_NodesCount, false),
-        NodesCount(_NodesCount) {}
-    std::vector<bool>::reference operator()(size_t I, size_t J) {
-      return this->operator[](I*NodesCount+J);
-    }
-    std::vector<bool>::const_reference operator()(size_t I, size_t J) const {
-      return this->operator[](I*NodesCount+J);
-    }
-  };
-
-  bool isReachable(const llvm::BasicBlock &From, const llvm::BasicBlock &To) {
-    return mReachabilityMatrix(mBBToInd[&From], mBBToInd[&To]);
-  }
-
-  void solveReachability() {
-    mReachabilityMatrix=ReachabilityMatrix(mF.size());
-    size_t Ind=0;
-    mBBToInd.init(mF.size());
-    for (auto &BB : mF) {
-      // mReachabilityMatrix(Ind, Ind)=true;
-      mBBToInd[&BB]=Ind++;
-    }
-    for (auto &BB : mF)
-      for (auto SuccBB : llvm::successors(&BB))
-        mReachabilityMatrix(mBBToInd[&BB], mBBToInd[SuccBB])=true;
-    for (size_t K=0; K<mReachabilityMatrix.NodesCount; ++K)
-      for (size_t I=0; I<mReachabilityMatrix.NodesCount; ++I)
-        for (size_t J=0; J<mReachabilityMatrix.NodesCount; ++J)
-          mReachabilityMatrix(I, J)=mReachabilityMatrix(I, J) |
-              (mReachabilityMatrix(I, K) & mReachabilityMatrix(K, J));
+  /// Return true if `To` is reachable from `From` through a non-empty path.
+  ///
+  /// If reachability is unknown, conservatively return true.
+  bool isReachable(const llvm::BasicBlock &From,
+      const llvm::BasicBlock &To) const {
+    return !mReachability || mReachability->isReachable(&From, &To);
   }
 
   // Returns true if there exist memory dependence between 2 instr-ons
@@ -572,9 +546,8 @@ private:
   const llvm::Function &mF;
   const AliasTree &mAT;
   const llvm::TargetLibraryInfo &mTLI;
-  bool mSolvedReachability, mSimplified, mCreatedPiBlocks;
-  ReachabilityMatrix mReachabilityMatrix;
-  llvm::DenseMap<const llvm::BasicBlock*, size_t> mBBToInd;
+  const BasicBlockReachability *mReachability;
+  bool mSimplified, mCreatedPiBlocks;
   DIMemoryClientServerInfo &mDIMInfo;
   std::optional<SpanningTreeRelation<const DIAliasTree*>> mServerDIATRel;
   SpanningTreeRelation<const DIAliasTree*> mClientDIATRel;
@@ -64,6 +64,12 @@ void initializeDFRegionInfoPassPass(PassRegistry &Registry);
 /// Create a pass to build hierarchy of data-flow regions.
 FunctionPass * createDFRegionInfoPass();
 
+/// Initialize a pass to compute reachability of basic blocks.
+void initializeBasicBlockReachabilityPassPass(PassRegistry &Registry);
+
+/// Create a pass to compute reachability of basic blocks.
+FunctionPass * createBasicBlockReachabilityPass();
+
 /// Initialize a wrapper to access analysis socket.
 void initializeAnalysisSocketImmutableWrapperPass(PassRegistry &Registry);
 
@@ -118,6 +124,23 @@ ModulePass *createAnalysisCloseConnectionPass(bool ActiveOnly = false);
 /// be blocked until server confirms that connection can be closed.
 ModulePass *createAnalysisCloseConnectionPass(const void * ServerID);
 
+/// Initialize a pass to access functions modified by transformation passes.
+void initializeFunctionChangeWrapperPass(PassRegistry &Registry);
+
+/// Initialize a pass to store functions modified by transformation passes.
+void initializeFunctionChangeStoragePass(PassRegistry &Registry);
+
+/// Create a pass to store functions modified by transformation passes.
+ImmutablePass *createFunctionChangeStorage();
+
+/// Initialize a pass to determine functions which have been modified
+/// since the previous execution of this pass.
+void initializeFunctionChangeTrackerPass(PassRegistry &Registry);
+
+/// Create a pass to determine functions which have been modified
+/// since the previous execution of this pass.
+ModulePass *createFunctionChangeTracker();
+
 /// Initialize a pass to build control dependence graph from source code.
 void initializeProgramDependencyGraphPassPass(PassRegistry &Registry);
 
@@ -0,0 +1,72 @@
+//===- Reachability.h --- Basic Block Reachability --------------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a pass to compute reachability of basic blocks in a
+// function. Other passes may request it to answer whether one block may be
+// executed after another without repeated traversals of a control-flow graph.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TSAR_REACHABILITY_H
+#define TSAR_REACHABILITY_H
+
+#include "tsar/ADT/ReachabilityMatrix.h"
+#include "tsar/Analysis/Passes.h"
+#include <bcl/utility.h>
+#include <llvm/IR/CFG.h>
+#include <llvm/Pass.h>
+
+namespace tsar {
+/// Reachability of basic blocks in a function.
+using BasicBlockReachability = ReachabilityMatrix<const llvm::Function *>;
+}
+
+namespace llvm {
+/// This pass computes reachability of basic blocks in a function.
+class BasicBlockReachabilityPass :
+  public FunctionPass, private bcl::Uncopyable {
+public:
+  /// Pass identification, replacement for typeid.
+  static char ID;
+
+  /// Default constructor.
+  BasicBlockReachabilityPass() : FunctionPass(ID) {
+    initializeBasicBlockReachabilityPassPass(*PassRegistry::getPassRegistry());
+  }
+
+  /// Return reachability of basic blocks in the last analyzed function.
+  const tsar::BasicBlockReachability &getReachability() const noexcept {
+    return mReachability;
+  }
+
+  /// Compute reachability of basic blocks in a specified function.
+  bool runOnFunction(Function &F) override;
+
+  /// Specifies a list of analyzes  that are necessary for this pass.
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+
+  /// Releases memory.
+  void releaseMemory() override { mReachability.clear(); }
+
+private:
+  tsar::BasicBlockReachability mReachability;
+};
+}
+#endif//TSAR_REACHABILITY_H
@@ -0,0 +1,147 @@
+//===- AnalysisBinary.h --- Binary Analysis Results -------------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a compact binary format to store external analysis
+// results. The format is understood by the reader and the writer of analysis
+// results and it is intended to be produced by a dynamic analysis tool as well.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TSAR_ANALYSIS_BINARY_H
+#define TSAR_ANALYSIS_BINARY_H
+
+#include "tsar/Analysis/Reader/AnalysisJSONStream.h"
+#include <cstdint>
+
+namespace llvm {
+class raw_ostream;
+}
+
+namespace tsar {
+namespace trait {
+/// Description of a binary format of external analysis results.
+///
+/// All values are little-endian, each field is 4 bytes long unless otherwise
+/// specified. A file consists of a header and sections which follow each
+/// other in the order listed below.
+/// - Header: magic, version, NumStrings, StringDataSize, NumFunctions,
+///   NumVars, NumFiles, NumLoops, NumTraits.
+/// - String table: NumStrings pairs (Offset, Size) followed by StringDataSize
+///   bytes of string data. Strings are referenced by indices.
+/// - Functions: records (File, Line, Column, Name, Flags).
+/// - Variables: records (File, Line, Column, Name), a variable is referenced
+///   by its index in this section.
+/// - File index: records (File, FirstLoop, NumLoops), loops which are located
+///   in the same file are stored contiguously and sorted by line and column.
+/// - Loops: records (File, Line, Column, FirstTrait, NumTraits).
+/// - Traits: records (Var, Kind : 1, Mask : 1, Reserved : 2, A, B, C) for each
+///   pair (loop, variable, trait), meaning of A, B, C depends on a trait kind
+///   and the Mask specifies which of them are set.
+namespace binary {
+/// Magic number at the beginning of a file.
+constexpr char Magic[8] = {'T', 'S', 'A', 'R', 'D', 'Y', 'N', 'A'};
+
+/// Current version of the format.
+constexpr uint32_t Version = 1;
+
+/// Kind of a trait record.
+enum class TraitKind : uint8_t {
+  Private,
+  Reduction,     // A: reduction kind
+  Induction,     // A, B, C: start, end, step
+  Flow,          // A, B: min and max distance
+  Anti,          // A, B: min and max distance
+  Output,
+  WriteOccurred,
+  ReadOccurred,
+  UseAfterLoop,
+  DefBeforeLoop,
+  NumberOf
+};
+
+/// Bits of a mask which specify known values in a trait record.
+enum TraitMask : uint8_t { HasA = 1u << 0, HasB = 1u << 1, HasC = 1u << 2 };
+
+/// Bits of function flags.
+enum FunctionFlags : uint32_t { Pure = 1u << 0 };
+
+/// Size of a header in bytes.
+constexpr std::size_t HeaderSize = sizeof(Magic) + 8 * sizeof(uint32_t);
+
+/// Size of records in bytes.
+constexpr std::size_t StringEntrySize = 2 * sizeof(uint32_t);
+constexpr std::size_t FunctionSize = 5 * sizeof(uint32_t);
+constexpr std::size_t VarSize = 4 * sizeof(uint32_t);
+constexpr std::size_t FileSize = 3 * sizeof(uint32_t);
+constexpr std::size_t LoopSize = 5 * sizeof(uint32_t);
+constexpr std::size_t TraitSize = 5 * sizeof(uint32_t);
+}
+
+/// Return true if a specified buffer contains results in the binary format.
+bool isBinaryInfo(llvm::StringRef Buffer);
+
+/// Write analysis results in the binary format.
+void writeBinaryInfo(const Info &Info, llvm::raw_ostream &OS);
+
+/// Streaming reader of external analysis results in the binary format.
+///
+/// Loops are grouped by files, so loops from files which are not accepted
+/// by a filter are skipped without access to their records.
+class BinaryInfoStream : public InfoStream {
+public:
+  explicit BinaryInfoStream(std::unique_ptr<llvm::MemoryBuffer> Buffer)
+      : InfoStream(std::move(Buffer)) {}
+
+  bool scan(VisitorT Visitor, FilterT Filter) override;
+  bool readRecord(llvm::StringRef Raw, Record &R) const override;
+  bool parse(llvm::StringRef Raw, Function &F,
+             ErrorList &Errors) const override;
+  bool parse(llvm::StringRef Raw, Loop &L, ErrorList &Errors) const override;
+
+private:
+  /// Check that the header and the string table are consistent with
+  /// the size of a file and compute bounds of sections.
+  bool init();
+
+  /// Return a string with a specified index.
+  llvm::StringRef getString(uint32_t Idx) const;
+
+  /// Return true if a specified record is located in a section.
+  bool isIn(llvm::StringRef Raw, const char *Section, uint32_t Num,
+            std::size_t RecordSize) const;
+
+  uint32_t mNumStrings = 0;
+  uint32_t mNumFunctions = 0;
+  uint32_t mNumVars = 0;
+  uint32_t mNumFiles = 0;
+  uint32_t mNumLoops = 0;
+  uint32_t mNumTraits = 0;
+  const char *mStrings = nullptr;
+  const char *mStringData = nullptr;
+  uint32_t mStringDataSize = 0;
+  const char *mFunctions = nullptr;
+  const char *mVars = nullptr;
+  const char *mFiles = nullptr;
+  const char *mLoops = nullptr;
+  const char *mTraits = nullptr;
+};
+}
+}
+#endif//TSAR_ANALYSIS_BINARY_H
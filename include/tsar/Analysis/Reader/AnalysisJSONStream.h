@@ -0,0 +1,132 @@
+//===- AnalysisJSONStream.h --- Analysis Results Stream ---------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a lightweight reader which scans external analysis results
+// in JSON format without building of a whole DOM in memory.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TSAR_ANALYSIS_JSON_STREAM_H
+#define TSAR_ANALYSIS_JSON_STREAM_H
+
+#include "tsar/Analysis/Reader/AnalysisJSON.h"
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/ADT/Twine.h>
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tsar {
+namespace trait {
+/// Streaming reader of external analysis results (see trait::Info).
+///
+/// A file is mapped into memory and it is never copied. The reader walks
+/// through the lists of records (functions, variables and loops) and decodes
+/// only a location of each record. Other fields are skipped, so a caller
+/// decides which records should be materialized.
+///
+/// Results may be stored in JSON or in a binary format (see AnalysisBinary.h),
+/// the format is detected automatically when a file is opened.
+class InfoStream {
+public:
+  /// Kind of a record in the top-level object.
+  enum class RecordKind { Function, Var, Loop };
+
+  /// Location of a record and its raw representation.
+  struct Record {
+    /// Raw representation of a record, it points to the mapped file.
+    llvm::StringRef Raw;
+    std::string File;
+    LineTy Line = 0;
+    ColumnTy Column = 0;
+    std::string Name;
+  };
+
+  /// Visitor of records, it is called for each record in order of occurrence.
+  using VisitorT = llvm::function_ref<void(RecordKind, const Record &)>;
+
+  /// Filter of records, only records accepted by the filter are visited.
+  ///
+  /// The filter is checked before other fields of a record are decoded.
+  /// Variables are always visited because they are accessed by indices.
+  using FilterT = llvm::function_ref<bool(RecordKind, llvm::StringRef File)>;
+
+  /// List of errors which occur during materialization of a record.
+  using ErrorList = std::vector<std::string>;
+
+  /// Map a specified file into memory.
+  static llvm::ErrorOr<std::unique_ptr<InfoStream>>
+  open(const llvm::Twine &Path);
+
+  virtual ~InfoStream() = default;
+
+  /// Scan the whole file and visit records accepted by a filter.
+  ///
+  /// Return false if the file is malformed, getError() describes a problem.
+  virtual bool scan(VisitorT Visitor, FilterT Filter) = 0;
+
+  /// Decode location of a record from its raw representation.
+  ///
+  /// Return false if the representation is malformed.
+  virtual bool readRecord(llvm::StringRef Raw, Record &R) const = 0;
+
+  /// Materialize a function from its raw representation.
+  virtual bool parse(llvm::StringRef Raw, Function &F,
+                     ErrorList &Errors) const = 0;
+
+  /// Materialize a loop from its raw representation.
+  virtual bool parse(llvm::StringRef Raw, Loop &L, ErrorList &Errors) const = 0;
+
+  /// Return description of the last error.
+  llvm::StringRef getError() const noexcept { return mError; }
+
+  /// Return the mapped file.
+  const llvm::MemoryBuffer &getBuffer() const noexcept { return *mBuffer; }
+
+protected:
+  explicit InfoStream(std::unique_ptr<llvm::MemoryBuffer> Buffer)
+      : mBuffer(std::move(Buffer)) {
+    assert(mBuffer && "Buffer must not be null!");
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer> mBuffer;
+  std::string mError;
+};
+
+/// Streaming reader of external analysis results in JSON format.
+///
+/// Each record is materialized with json::Parser on demand.
+class JSONInfoStream : public InfoStream {
+public:
+  explicit JSONInfoStream(std::unique_ptr<llvm::MemoryBuffer> Buffer)
+      : InfoStream(std::move(Buffer)) {}
+
+  bool scan(VisitorT Visitor, FilterT Filter) override;
+  bool readRecord(llvm::StringRef Raw, Record &R) const override;
+  bool parse(llvm::StringRef Raw, Function &F,
+             ErrorList &Errors) const override;
+  bool parse(llvm::StringRef Raw, Loop &L, ErrorList &Errors) const override;
+};
+}
+}
+#endif//TSAR_ANALYSIS_JSON_STREAM_H
@@ -0,0 +1,51 @@
+//===- AnalysisMerge.h --- Analysis Results Merger --------------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares functions to merge external analysis results which are
+// obtained in different runs of a program (for example, from different
+// processes or for different input data).
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TSAR_ANALYSIS_MERGE_H
+#define TSAR_ANALYSIS_MERGE_H
+
+#include "tsar/Analysis/Reader/AnalysisJSON.h"
+#include <vector>
+
+namespace tsar {
+namespace trait {
+/// Merge results of an analysis run `From` into results `To`.
+///
+/// Functions, variables and loops are matched by their locations. An access
+/// or a dependence which occurs in any run is preserved. A property which
+/// requires absence of dependencies (private, reduction, induction) is
+/// preserved only if it holds in all runs which access a variable in a loop.
+/// A function is pure only if it is pure in all runs.
+void mergeInfo(Info &To, const Info &From);
+
+/// Merge results of multiple runs with a parallel reduction tree.
+///
+/// \param [in] Jobs Number of threads, 0 means the number of available
+/// hardware threads.
+Info mergeInfo(std::vector<Info> &&Runs, unsigned Jobs = 0);
+}
+}
+#endif//TSAR_ANALYSIS_MERGE_H
@@ -0,0 +1,95 @@
+//===- AnalysisCache.h --- Analysis Results Cache ---------------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a persistent on-disk cache of analysis results for
+// translation units. It allows the tool to skip analysis of translation units
+// which have not been changed since the previous run.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TSAR_ANALYSIS_CACHE_H
+#define TSAR_ANALYSIS_CACHE_H
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Error.h>
+#include <string>
+
+namespace clang::tooling {
+class CompilationDatabase;
+}
+
+namespace tsar {
+/// Results of processing of a single translation unit.
+struct AnalysisCacheEntry {
+  /// Exit code of processing (see clang::tooling::ClangTool::run()).
+  int Result = 0;
+
+  /// Diagnostics and printed results of analysis.
+  std::string Output;
+};
+
+/// \brief This is a persistent on-disk cache of analysis results.
+///
+/// Each entry is stored in a separate binary file in a cache directory.
+/// The name of the file is a key of a translation unit. The key is a hash of
+/// the preprocessed source (including locations of tokens), the compile
+/// command, the tool options (including contents of input files the options
+/// refer to) and the tool version. So, an entry remains valid until some of these
+/// components is changed.
+class AnalysisCache {
+public:
+  /// Create cache which is stored in a specified directory.
+  explicit AnalysisCache(llvm::StringRef Dir) : mDir(Dir) {}
+
+  /// Return directory the cache is stored in.
+  llvm::StringRef getDirectory() const noexcept { return mDir; }
+
+  /// \brief Compute key of a specified source file.
+  ///
+  /// The source is preprocessed in accordance with a compilation database.
+  /// Options of the tool which may affect analysis results must be
+  /// specified in `ToolOptions`.
+  /// \return Key or `None` if the source cannot be preprocessed.
+  static llvm::Optional<std::string>
+  computeKey(const clang::tooling::CompilationDatabase &Compilations,
+             llvm::StringRef Source, llvm::ArrayRef<std::string> ToolOptions);
+
+  /// \brief Compute hash of contents of specified files.
+  ///
+  /// Files which are not sources but affect analysis results (for example,
+  /// external analysis results or profiles) should be hashed and the result
+  /// should be passed to computeKey() as one of the tool options.
+  static std::string hashFiles(llvm::ArrayRef<std::string> Files);
+
+  /// Return entry for a specified key if it exists.
+  llvm::Optional<AnalysisCacheEntry> lookup(llvm::StringRef Key) const;
+
+  /// Store entry for a specified key, replace the existing one.
+  ///
+  /// The cache directory is created if it does not exist.
+  llvm::Error store(llvm::StringRef Key, const AnalysisCacheEntry &Entry) const;
+
+private:
+  std::string mDir;
+};
+}
+#endif//TSAR_ANALYSIS_CACHE_H
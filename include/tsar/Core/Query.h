@@ -38,6 +38,7 @@ class DataLayout;
 class Pass;
 class PassInfo;
 class Module;
+class raw_ostream;
 class raw_pwrite_stream;
 
 namespace legacy {
@@ -239,6 +240,13 @@ public:
   /// Initializes external storage to access information about import process.
   ASTImportInfo * initializeImportInfo() override { return &mImportInfo; }
 
+  /// Redirects results of print passes to a specified stream (the standard
+  /// error stream is used by default).
+  ///
+  /// This allows to buffer output of each query manager if multiple
+  /// translation units are analyzed in parallel.
+  void setPrintStream(llvm::raw_ostream &OS) noexcept { mPrintOS = &OS; }
+
 private:
   /// Updates pass manager. Adds a specified pass and a pass to print its result
   // if `PrintResult` is set to 'true`.
@@ -251,6 +259,7 @@ private:
   ProcessingStep mPrintSteps;
   const GlobalOptions *mGlobalOptions;
   ASTImportInfo mImportInfo;
+  llvm::raw_ostream *mPrintOS = nullptr;
 };
 
 /// This prints LLVM IR to the standard output stream.
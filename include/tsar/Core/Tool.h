@@ -96,6 +96,19 @@ private:
   ///
   void storePrintOptions(OptionList &IncompatibleOpts);
 
+  /// \brief Analyzes each of specified C/C++ sources separately on a pool
+  /// of mJobs threads.
+  ///
+  /// Each source is processed by its own query manager with a default pass
+  /// sequence. Each worker owns LLVM context (see ClangMainAction), virtual
+  /// file system and buffers for diagnostics and printed results. Buffers
+  /// are flushed to the standard error stream in order of sources when all
+  /// workers finish. If mCacheDir is set, buffers of successfully processed
+  /// sources are cached and analysis of unchanged sources is skipped.
+  /// \return Zero on success, 1 if processing of some sources failed and 2 if
+  /// some sources have been skipped (similar to clang::tooling::ClangTool).
+  int runInParallel(llvm::ArrayRef<std::string> Sources);
+
   std::string mToolName;
   GlobalOptions mGlobalOpts;
   std::vector<std::string> mCommandLine;
@@ -116,6 +129,10 @@ private:
   bool mPrint = false;
   bool mServer = false;
   bool mLoadSources = true;
+  unsigned mJobs = 1;
+  std::string mProfileFilename;
+  std::string mCacheDir;
+  std::vector<std::string> mToolOptions;
   std::string mOutputFilename;
   std::string mLanguage;
   std::string mInstrEntry;
@@ -28,12 +28,21 @@
 #include <llvm/Analysis/LoopInfo.h>
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/Type.h>
+#include <llvm/ADT/Hashing.h>
 #include <llvm/ADT/SmallVector.h>
 
 namespace tsar {
 /// Returns argument with a specified number or nullptr.
 llvm::Argument * getArgument(llvm::Function &F, std::size_t ArgNo);
 
+/// \brief Computes hash of a function body.
+///
+/// The hash does not depend on names of local values, so it remains the same
+/// while the function is not modified. Note, that global values and constants
+/// are identified by their addresses, so hashes are comparable inside a single
+/// LLVM context only.
+llvm::hash_code hashFunction(const llvm::Function &F);
+
 /// Returns number of dimensions in a specified type or 0 if it is not an array.
 inline unsigned dimensionsNum(const llvm::Type *Ty) {
   unsigned Dims = 0;
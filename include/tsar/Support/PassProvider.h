@@ -36,6 +36,18 @@
 // initialize a such passes.
 //
 // To avoid this problems a provider pass could be used.
+//
+// Note, that a module pass which accesses a provider for the same function
+// several times still re-executes the whole pass sequence on each access.
+// Use getCachedProvider() to reuse results of the last execution if the
+// version of the function has not been changed since then. Note, that this
+// cache is not an LRU cache of several functions. The legacy pass manager
+// releases all on the fly passes before each execution, so results for
+// a function can not be retained without copying them when another function
+// is analyzed. Each module pass has its own on the fly passes, so the cache
+// holds at most one function for each module pass which requires the provider,
+// and alternating accesses to two functions from the same module pass
+// re-execute analysis each time.
 //===----------------------------------------------------------------------===//
 
 #ifndef TSAR_PASS_PROVIDER_H
@@ -208,6 +220,36 @@ public:
     return false;
   }
 
+  /// Forget a function results of analysis have been cached for.
+  ///
+  /// On the fly passes are released before each execution, so cached results
+  /// become invalid.
+  void releaseMemory() override { mCachedFunction = nullptr; }
+
+  /// \brief Remember that this provider holds results of analysis for a
+  /// specified version of a function.
+  ///
+  /// Results remain available until the next execution of on the fly passes
+  /// or until the version of the function is changed. The zero version is
+  /// unknown, so results for it are not cached.
+  void setCached(llvm::Function &F, uint64_t Version) {
+    mCachedFunction = Version != 0 ? &F : nullptr;
+    mCachedVersion = Version;
+  }
+
+  /// Return provider which holds results of analysis for a specified
+  /// version of a function.
+  static FunctionPassProvider *findCached(llvm::Function &F,
+                                          uint64_t Version) {
+    for (auto *Provider : ProviderList)
+      if (Provider->mCachedFunction == &F) {
+        if (Provider->mCachedVersion == Version)
+          return Provider;
+        Provider->mCachedFunction = nullptr;
+      }
+    return nullptr;
+  }
+
   /// Specifies that all analyzes declared as template parameters of this pass
   /// are required to be performed before execution of the pass.
   void getAnalysisUsage(llvm::AnalysisUsage &AU) const override {
@@ -242,6 +284,8 @@ public:
 private:
   static ProviderListT ProviderList;
   AnalysisMap mPasses;
+  llvm::Function *mCachedFunction = nullptr;
+  uint64_t mCachedVersion = 0;
 };
 
 template<class... Analysis>
@@ -292,6 +336,28 @@ struct is_pass_provider<T, enable_if_pass_provider<T>> : std::true_type {};
 template<class T>
 using pass_provider_analysis =
     decltype(detail::check_pass_provider(std::declval<T>()));
+
+/// \brief Return provider of a specified type which holds results of analysis
+/// for a function F.
+///
+/// Analysis passes are executed on the fly only if there are no results for
+/// a specified `Version` of F. The version must be changed on each
+/// modification of F and versions of different functions must not be equal
+/// (see FunctionChangeInfo::getVersion()), so a function is never hashed on
+/// lookup. The zero version means that the version of F is unknown and the
+/// analysis is always executed. Results of the last execution are retained
+/// only, because each on the fly pass holds results for a single function.
+/// \pre Initialization of the provider (see FunctionPassProvider::initialize())
+/// must be the same between consecutive calls.
+template <class ProviderT>
+ProviderT &getCachedProvider(llvm::Pass &P, llvm::Function &F,
+                             uint64_t Version) {
+  if (auto *Provider = ProviderT::findCached(F, Version))
+    return static_cast<ProviderT &>(*Provider);
+  auto &Provider = P.getAnalysis<ProviderT>(F);
+  Provider.setCached(F, Version);
+  return Provider;
+}
 }
 
 #endif//TSAR_PASS_PROVIDER_H
@@ -46,6 +46,7 @@ public:
     Release = 'r',
     Notify = 'n',
     Data = 'd',
+    Typed = 't',
     Invalid = 'i',
   };
 
@@ -29,9 +29,14 @@
 #include <llvm/ADT/StringRef.h>
 #include <llvm/ADT/SmallPtrSet.h>
 #include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/SmallVector.h>
 #include <llvm/Pass.h>
 #include <llvm/Support/raw_ostream.h>
 
+namespace llvm {
+class Function;
+}
+
 namespace llvm::sys::fs {
 class TempFile;
 }
@@ -135,5 +140,34 @@ bool operator!=(const llvm::SmallPtrSet<PtrType, SmallSize> &LHS,
   return !(LHS == RHS);
 }
 
+
+/// \brief This records sizes of data structures which a pass builds for a
+/// function in a time trace.
+///
+/// Sizes are recorded only if time trace profiler is enabled. They are
+/// attached as a detail to an event with zero duration which is added on
+/// destruction of this object. Change of memory allocated by malloc since
+/// construction of this object is also recorded.
+class TimeTraceSizes {
+public:
+  TimeTraceSizes(llvm::StringRef Name, const llvm::Function &F);
+  ~TimeTraceSizes();
+
+  /// Return true if sizes are recorded.
+  bool isEnabled() const noexcept { return mIsEnabled; }
+
+  /// Record size of a specified data structure.
+  void add(llvm::StringRef What, std::size_t Size) {
+    if (mIsEnabled)
+      mSizes.emplace_back(What, Size);
+  }
+
+private:
+  bool mIsEnabled = false;
+  std::string mName;
+  std::string mFunction;
+  std::size_t mMallocUsage = 0;
+  llvm::SmallVector<std::pair<llvm::StringRef, std::size_t>, 4> mSizes;
+};
 }
 #endif // TSAR_SUPPORT_UTILS_H
@@ -26,10 +26,17 @@
 
 #include "tsar/Analysis/AnalysisSocket.h"
 #include "tsar/Analysis/Passes.h"
+#include <llvm/Support/CommandLine.h>
 
 using namespace llvm;
 using namespace tsar;
 
+static cl::opt<bool> ClAnalysisSocketJSON("analysis-socket-json", cl::Hidden,
+  cl::init(false),
+  cl::desc("Encode requests to analysis server as JSON (for debugging)"));
+
+bool AnalysisSocket::isJSONEnabled() { return ClAnalysisSocketJSON; }
+
 namespace {
 class AnalysisSocketImmutableStorage :
   public ImmutablePass, private bcl::Uncopyable {
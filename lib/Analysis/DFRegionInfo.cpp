@@ -24,6 +24,7 @@
 
 #include "tsar/Analysis/DFRegionInfo.h"
 #include "tsar/Analysis/LoopTraits.h"
+#include "tsar/Support/Utils.h"
 #include <llvm/ADT/Statistic.h>
 #include <llvm/Analysis/LoopInfo.h>
 #include <llvm/InitializePasses.h>
@@ -168,7 +169,19 @@ void DFRegionInfo::buildLoopRegion(LoopReptn L, DFRegion *R) {
 
 bool DFRegionInfoPass::runOnFunction(Function &F) {
   auto &LpInfo = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+  TimeTraceSizes Trace("DFRegionInfo", F);
   mRegionInfo.recalculate(F, LpInfo);
+  if (Trace.isEnabled()) {
+    std::size_t NumNodes = 1;
+    SmallVector<DFRegion *, 8> Worklist{
+        cast<DFRegion>(mRegionInfo.getTopLevelRegion())};
+    do {
+      auto *R = Worklist.pop_back_val();
+      NumNodes += R->getNodes().size();
+      Worklist.append(R->getRegions().begin(), R->getRegions().end());
+    } while (!Worklist.empty());
+    Trace.add("nodes", NumNodes);
+  }
   return false;
 }
 
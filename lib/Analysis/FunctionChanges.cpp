@@ -0,0 +1,210 @@
+//===- FunctionChanges.cpp --- Function Change Tracker ----------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a tracker of functions which have been modified by
+// transformation passes between consecutive steps of analysis pipeline.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tsar/Analysis/FunctionChanges.h"
+#include "tsar/Analysis/Passes.h"
+#include "tsar/Support/IRUtils.h"
+#include <bcl/utility.h>
+#include <llvm/ADT/SCCIterator.h>
+#include <llvm/Analysis/CallGraph.h>
+#include <llvm/InitializePasses.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Pass.h>
+#include <llvm/Support/Debug.h>
+
+#undef DEBUG_TYPE
+#define DEBUG_TYPE "function-changes"
+
+using namespace llvm;
+using namespace tsar;
+
+namespace {
+class FunctionChangeTracker : public ModulePass, private bcl::Uncopyable {
+public:
+  static char ID;
+
+  FunctionChangeTracker() : ModulePass(ID) {
+    initializeFunctionChangeTrackerPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnModule(Module &M) override;
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+};
+
+class FunctionChangeStorage : public ImmutablePass, private bcl::Uncopyable {
+public:
+  static char ID;
+
+  FunctionChangeStorage() : ImmutablePass(ID) {
+    initializeFunctionChangeStoragePass(*PassRegistry::getPassRegistry());
+  }
+
+  void initializePass() override {
+    getAnalysis<FunctionChangeWrapper>().set(mChanges);
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<FunctionChangeWrapper>();
+    AU.setPreservesAll();
+  }
+
+  FunctionChangeInfo &getChanges() noexcept { return mChanges; }
+  const FunctionChangeInfo &getChanges() const noexcept { return mChanges; }
+
+private:
+  FunctionChangeInfo mChanges;
+};
+}
+
+char FunctionChangeStorage::ID = 0;
+INITIALIZE_PASS_BEGIN(FunctionChangeStorage, "function-changes-is",
+  "Function Change Tracker (Immutable Storage)", true, true)
+INITIALIZE_PASS_DEPENDENCY(FunctionChangeWrapper)
+INITIALIZE_PASS_END(FunctionChangeStorage, "function-changes-is",
+  "Function Change Tracker (Immutable Storage)", true, true)
+
+template<> char FunctionChangeWrapper::ID = 0;
+INITIALIZE_PASS(FunctionChangeWrapper, "function-changes-iw",
+  "Function Change Tracker (Immutable Wrapper)", true, true)
+
+char FunctionChangeTracker::ID = 0;
+INITIALIZE_PASS_BEGIN(FunctionChangeTracker, "function-changes",
+  "Function Change Tracker", true, true)
+INITIALIZE_PASS_DEPENDENCY(CallGraphWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(FunctionChangeWrapper)
+INITIALIZE_PASS_END(FunctionChangeTracker, "function-changes",
+  "Function Change Tracker", true, true)
+
+/// Collect values which identify a body of a function: arguments, basic
+/// blocks, instructions and values which instructions refer to.
+///
+/// Constant data are never deleted, so they are not collected.
+static void collectIdentities(Function &F, SmallVectorImpl<Value *> &Values) {
+  SmallPtrSet<Value *, 32> Visited;
+  auto collect = [&Values, &Visited](Value *V) {
+    if (Visited.insert(V).second)
+      Values.push_back(V);
+  };
+  for (auto &Arg : F.args())
+    collect(&Arg);
+  for (auto &BB : F) {
+    collect(&BB);
+    for (auto &I : BB) {
+      collect(&I);
+      for (auto *Op : I.operand_values())
+        if (!isa<ConstantData>(Op))
+          collect(Op);
+    }
+  }
+}
+
+void FunctionChangeInfo::update(Module &M, CallGraph &CG) {
+  ++mNumUpdates;
+  mModified.clear();
+  mAffected.clear();
+  mDeleted.clear();
+  for (auto I = mStates.begin(), EI = mStates.end(); I != EI; ++I)
+    if (!I->second.Function) {
+      mDeleted.push_back(I->first);
+      mStates.erase(I);
+    }
+  SmallVector<Value *, 256> Values;
+  for (auto &F : M) {
+    auto Hash = hashFunction(F);
+    Values.clear();
+    collectIdentities(F, Values);
+    auto Info = mStates.try_emplace(&F);
+    auto &State = Info.first->second;
+    if (!Info.second && State.Hash == Hash &&
+        State.Values.size() == Values.size() &&
+        std::equal(Values.begin(), Values.end(), State.Values.begin(),
+                   [](Value *V, const WeakVH &H) { return V == H; }))
+      continue;
+    State.Function = &F;
+    State.Hash = Hash;
+    State.Values.assign(Values.begin(), Values.end());
+    State.Version = ++mLastVersion;
+    mModified.insert(&F);
+  }
+  // Functions which are not reachable in the call graph are not visited below.
+  mAffected.insert(mModified.begin(), mModified.end());
+  // Callers are visited after callees in a bottom-up traversal.
+  for (auto SCC = scc_begin(&CG); !SCC.isAtEnd(); ++SCC) {
+    bool IsAffected = false;
+    for (auto *CGN : *SCC) {
+      auto *F = CGN->getFunction();
+      if (!F)
+        continue;
+      if (mModified.count(F)) {
+        IsAffected = true;
+        break;
+      }
+      for (auto &Callee : *CGN) {
+        // Summaries of a function with indirect calls may refer to values
+        // from any function, so it is not possible to prove that such function
+        // is not affected by modifications.
+        auto *CalleeF = Callee.second->getFunction();
+        if (CalleeF ? mAffected.count(CalleeF) : !mModified.empty()) {
+          IsAffected = true;
+          break;
+        }
+      }
+      if (IsAffected)
+        break;
+    }
+    if (IsAffected)
+      for (auto *CGN : *SCC)
+        if (auto *F = CGN->getFunction())
+          mAffected.insert(F);
+  }
+  LLVM_DEBUG(dbgs() << "[FUNCTION CHANGES]: update " << mNumUpdates
+                    << ", modified " << mModified.size() << ", affected "
+                    << mAffected.size() << ", deleted " << mDeleted.size()
+                    << " functions\n");
+}
+
+void FunctionChangeTracker::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<CallGraphWrapperPass>();
+  AU.addRequired<FunctionChangeWrapper>();
+  AU.setPreservesAll();
+}
+
+bool FunctionChangeTracker::runOnModule(Module &M) {
+  auto &Changes = getAnalysis<FunctionChangeWrapper>();
+  if (!Changes)
+    return false;
+  Changes->update(M, getAnalysis<CallGraphWrapperPass>().getCallGraph());
+  return false;
+}
+
+ModulePass *llvm::createFunctionChangeTracker() {
+  return new FunctionChangeTracker;
+}
+
+ImmutablePass *llvm::createFunctionChangeStorage() {
+  return new FunctionChangeStorage;
+}
@@ -37,6 +37,7 @@
 #include "tsar/Analysis/Memory/MemoryAccessUtils.h"
 #include "tsar/Analysis/Memory/MemoryTraitUtils.h"
 #include "tsar/Analysis/Memory/PrivateAnalysis.h"
+#include "tsar/Analysis/Memory/TieredAA.h"
 #include "tsar/Analysis/Memory/Utils.h"
 #include "tsar/Core/Query.h"
 #include "tsar/Support/GlobalOptions.h"
@@ -2217,6 +2218,7 @@ bool DIDependencyAnalysisPass::runOnFunction(Function &F) {
   mTLI = &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI(F);
   auto &PI = getAnalysis<PrivateRecognitionPass>().getPrivateInfo();
   auto &DIAT = getAnalysis<DIEstimateMemoryPass>().getAliasTree();
+  auto *TieredAA = getAnalysisIfAvailable<TieredAAWrapperPass>();
   auto &DL = F.getParent()->getDataLayout();
   auto DWLang = getLanguage(F);
   SpanningTreeRelation<AliasTree *> AliasSTR(mAT);
@@ -2225,6 +2227,8 @@ bool DIDependencyAnalysisPass::runOnFunction(Function &F) {
   std::deque<DFLoop *> LQ;
   for (auto *DFN : DFF->getRegions())
     addLoopIntoQueue(DFN, LQ);
+  TimeTraceSizes Trace("DIDependencyAnalysis", F);
+  std::size_t NumTraits{0};
   for (auto *DFL : LQ) {
     auto L = DFL->getLoop();
     /// TODO (kaniandr@gmail.com): use other identifier because LLVM identifier
@@ -2303,7 +2307,17 @@ bool DIDependencyAnalysisPass::runOnFunction(Function &F) {
           if (I != DIDepSet.end() && !I->is<trait::NoAccess>())
             I->set<trait::Flow, trait::Anti, trait::Output>();
         }
+    // Use more accurate alias analysis in the subsequent analysis of this
+    // function if aliasing prevents parallelization.
+    if (TieredAA && !TieredAA->getResult().isEscalated(F) &&
+        any_of(DIDepSet, [](const DIAliasTrait &AT) {
+          return AT.size() > 1 && !AT.is_any<trait::Shared, trait::Readonly>();
+        }))
+      TieredAA->getResult().escalate(F);
+    NumTraits += Pool->size();
   }
+  Trace.add("loops", LQ.size());
+  Trace.add("trait pool", NumTraits);
   return false;
 }
 
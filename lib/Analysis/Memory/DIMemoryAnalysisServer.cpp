@@ -24,6 +24,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "tsar/Analysis/AnalysisServer.h"
+#include "tsar/Analysis/Passes.h"
 #include "tsar/Analysis/Memory/ClonedDIMemoryMatcher.h"
 #include "tsar/Analysis/Memory/DefinedMemory.h"
 #include "tsar/Analysis/Memory/DIArrayAccess.h"
@@ -147,6 +148,7 @@ public:
     legacy::PassManager &PM) override {
     auto &GO = getAnalysis<GlobalOptionsImmutableWrapper>();
     PM.add(createGlobalOptionsImmutableWrapper(&GO.getOptions()));
+    PM.add(createFunctionChangeStorage());
     PM.add(createGlobalDefinedMemoryStorage());
     PM.add(createGlobalLiveMemoryStorage());
     PM.add(createDIMemoryTraitPoolStorage());
@@ -27,6 +27,7 @@
 #include "tsar/Analysis/Memory/MemoryAccessUtils.h"
 #include "tsar/Analysis/Memory/MemorySetInfo.h"
 #include "tsar/Support/IRUtils.h"
+#include "tsar/Support/Utils.h"
 #include "tsar/Unparse/Utils.h"
 #include <llvm/ADT/Statistic.h>
 #include <llvm/ADT/PointerUnion.h>
@@ -1017,7 +1018,7 @@ AliasTree::insert(const MemoryLocation &Base) {
         }
       }
       if (!UpdateChain) {
-        auto EM = new EstimateMemory(*Prev, Base.Size, Base.AATags);
+        auto EM = make_memory(*Prev, Base.Size, Base.AATags);
         ++NumEstimateMemory;
         CT::spliceNext(EM, Prev);
         return std::make_tuple(EM, true, AddAmbiguous);
@@ -1029,7 +1030,7 @@ AliasTree::insert(const MemoryLocation &Base) {
       }
       assert(MemorySetInfo<MemoryLocation>::sizecmp(
                Base.Size, UpdateChain->getSize()) < 0 && "Invariant broken!");
-      auto EM = new EstimateMemory(*UpdateChain, Base.Size, Base.AATags);
+      auto EM = make_memory(*UpdateChain, Base.Size, Base.AATags);
       ++NumEstimateMemory;
       CT::splicePrev(EM, UpdateChain);
       if (ChainBegin == UpdateChain)
@@ -1040,7 +1041,7 @@ AliasTree::insert(const MemoryLocation &Base) {
     BL = &mBases.insert(std::make_pair(StrippedPtr, BaseList())).first->second;
   }
   LLVM_DEBUG(dbgs() << "[ALIAS TREE]: build new chain\n");
-  auto Chain = new EstimateMemory(Base, AmbiguousRef::make(mAmbiguousPool));
+  auto Chain = make_memory(Base, AmbiguousRef::make(mAmbiguousPool));
   ++NumEstimateMemory;
   BL->push_back(Chain);
   return std::make_tuple(Chain, true, false);
@@ -1070,6 +1071,7 @@ FunctionPass * llvm::createEstimateMemoryPass() {
 
 bool EstimateMemoryPass::runOnFunction(Function &F) {
   releaseMemory();
+  TimeTraceSizes Trace("AliasTree", F);
   auto &DT = getAnalysis<DominatorTreeWrapperPass>().getDomTree();
   auto &AA = getAnalysis<AAResultsWrapperPass>().getAAResults();
   auto &TLI = getAnalysis<TargetLibraryInfoWrapperPass>().getTLI(F);
@@ -1152,5 +1154,6 @@ bool EstimateMemoryPass::runOnFunction(Function &F) {
       }
     }
   }
+  Trace.add("nodes", mAliasTree->size());
   return false;
 }
@@ -22,6 +22,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "tsar/Analysis/Attributes.h"
+#include "tsar/Analysis/FunctionChanges.h"
 #include "tsar/Analysis/Memory/DefinedMemory.h"
 #include "tsar/Analysis/Memory/Delinearization.h"
 #include "tsar/Analysis/Memory/EstimateMemory.h"
@@ -38,6 +39,7 @@
 #include <llvm/InitializePasses.h>
 #include <llvm/IR/Function.h>
 #include <llvm/Pass.h>
+#include <llvm/Support/CommandLine.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/IR/Dominators.h>
 
@@ -47,6 +49,11 @@
 using namespace llvm;
 using namespace tsar;
 
+static cl::opt<unsigned> MaxRecursionIterations(
+    "global-def-mem-max-iterations", cl::init(8), cl::Hidden,
+    cl::desc("Maximum number of iterations to compute def-use summaries for "
+             "recursive functions"));
+
 namespace {
 class GlobalDefinedMemory : public ModulePass, private bcl::Uncopyable {
 public:
@@ -58,6 +65,22 @@ public:
 
   bool runOnModule(Module &SCC) override;
   void getAnalysisUsage(AnalysisUsage& AU) const override;
+
+private:
+  /// Compute def-use summary for a specified function using summaries from
+  /// a specified list to analyze calls.
+  std::unique_ptr<DefUseSet> analyzeFunction(Function &F,
+                                             const GlobalOptions &GO,
+                                             InterprocDefUseInfo &Info);
+
+  /// Compute summaries for functions from a recursive SCC.
+  ///
+  /// Summaries are evaluated iteratively, calls inside the SCC initially
+  /// have no side effects. If a fixpoint is not reached in a bounded number of
+  /// iterations, summaries are dropped and calls of the SCC functions are
+  /// analyzed conservatively.
+  void analyzeRecursion(ArrayRef<CallGraphNode *> SCC, const GlobalOptions &GO,
+                        InterprocDefUseInfo &Info);
 };
 
 class GlobalDefinedMemoryStorage :
@@ -130,6 +153,7 @@ INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(GlobalDefinedMemoryProvider)
 INITIALIZE_PASS_DEPENDENCY(GlobalDefinedMemoryWrapper)
 INITIALIZE_PASS_DEPENDENCY(GlobalOptionsImmutableWrapper)
+INITIALIZE_PASS_DEPENDENCY(FunctionChangeWrapper)
 INITIALIZE_PASS_END(GlobalDefinedMemory, "global-def-mem",
                     "Global Defined Memory Analysis", true, true)
 
@@ -140,6 +164,7 @@ void GlobalDefinedMemory::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequired<TargetLibraryInfoWrapperPass>();
   AU.addRequired<GlobalOptionsImmutableWrapper>();
   AU.addRequired<GlobalsAccessWrapper>();
+  AU.addRequired<FunctionChangeWrapper>();
   AU.setPreservesAll();
 }
 
@@ -155,7 +180,14 @@ bool GlobalDefinedMemory::runOnModule(Module &SCC) {
   auto &Wrapper = getAnalysis<GlobalDefinedMemoryWrapper>();
   if (!Wrapper)
     return false;
-  Wrapper->clear();
+  // Summaries of functions which are not affected by transformations remain
+  // valid, so they are reused.
+  auto &Changes = getAnalysis<FunctionChangeWrapper>();
+  if (Changes)
+    for (auto *F : Changes->deleted())
+      Wrapper->erase(const_cast<Function *>(F));
+  else
+    Wrapper->clear();
   auto &GO = getAnalysis<GlobalOptionsImmutableWrapper>().getOptions();
   GlobalDefinedMemoryProvider::initialize<GlobalOptionsImmutableWrapper>(
       [&GO](GlobalOptionsImmutableWrapper &Wrapper) {
@@ -166,13 +198,25 @@ bool GlobalDefinedMemory::runOnModule(Module &SCC) {
     GlobalDefinedMemoryProvider::initialize<GlobalsAccessWrapper>(
         [&GAP](GlobalsAccessWrapper &Wrapper) { Wrapper.set(*GAP); });
   auto &CG = getAnalysis<CallGraphWrapperPass>().getCallGraph();
-  auto &DL = SCC.getDataLayout();
   for (scc_iterator<CallGraph *> SCC = scc_begin(&CG); !SCC.isAtEnd(); ++SCC) {
-    /// TODO (kaniandr@gmail.com): implement analysis in case of recursion.
-    if (SCC->size() > 1)
-      continue;
+    if (Changes)
+      for (auto *CGN : *SCC)
+        if (auto *F = CGN->getFunction(); F && Changes->isAffected(*F))
+          Wrapper->erase(F);
     CallGraphNode *CGN = *SCC->begin();
+    if (SCC->size() > 1 ||
+        any_of(*CGN, [CGN](const CallGraphNode::CallRecord &CR) {
+          return CR.second == CGN;
+        })) {
+      analyzeRecursion(*SCC, GO, *Wrapper);
+      continue;
+    }
     auto F = CGN->getFunction();
+    if (F && Wrapper->count(F)) {
+      LLVM_DEBUG(dbgs() << "[GLOBAL DEFINED MEMORY]: reuse summary for "
+                        << F->getName() << "\n";);
+      continue;
+    }
     // Indirect calls or calls to functions without body may lead to implicit
     // recursion. So, disable analysis in this case.
     // TODO (kaniandr@gmail.com): sapfor.direct-user-callee is not set for
@@ -180,26 +224,85 @@ bool GlobalDefinedMemory::runOnModule(Module &SCC) {
     // and these functions should be pre-analyzed.
     if (!F || F->empty() || !hasFnAttr(*F, AttrKind::DirectUserCallee))
       continue;
-    LLVM_DEBUG(dbgs() << "[GLOBAL DEFINED MEMORY]: analyze " << F->getName()
-                      << "\n";);
-    auto &TLI = getAnalysis<TargetLibraryInfoWrapperPass>().getTLI(*F);
-    auto &Provider = getAnalysis<GlobalDefinedMemoryProvider>(*F);
-    auto &RegInfo = Provider.get<DFRegionInfoPass>().getRegionInfo();
-    auto &AT = Provider.get<EstimateMemoryPass>().getAliasTree();
-    const auto &DT = Provider.get<DominatorTreeWrapperPass>().getDomTree();
-    auto *DFF = cast<DFFunction>(RegInfo.getTopLevelRegion());
-    auto &DI = Provider.get<DelinearizationPass>().getDelinearizeInfo();
-    auto &SE = Provider.get<ScalarEvolutionWrapperPass>().getSE();
-    DefinedMemoryInfo DefInfo;
-    ReachDFFwk ReachDefFwk(AT, TLI, RegInfo, DT, DI, SE, DL, GO, DefInfo,
-                           *Wrapper);
-    solveDataFlowUpward(&ReachDefFwk, DFF);
-    auto DefUseSetItr = ReachDefFwk.getDefInfo().find(DFF);
-    assert(DefUseSetItr != ReachDefFwk.getDefInfo().end() &&
-           "Def-use set must exist for a function!");
-    Wrapper->try_emplace(F, std::move(DefUseSetItr->get<DefUseSet>()));
-    LLVM_DEBUG(dbgs() << "[GLOBAL DEFINED MEMORY]: leave " << F->getName()
-                      << "\n";);
+    Wrapper->try_emplace(F, analyzeFunction(*F, GO, *Wrapper));
   }
   return false;
 }
+
+std::unique_ptr<DefUseSet>
+GlobalDefinedMemory::analyzeFunction(Function &F, const GlobalOptions &GO,
+                                     InterprocDefUseInfo &Info) {
+  LLVM_DEBUG(dbgs() << "[GLOBAL DEFINED MEMORY]: analyze " << F.getName()
+                    << "\n";);
+  auto &DL = F.getParent()->getDataLayout();
+  auto &TLI = getAnalysis<TargetLibraryInfoWrapperPass>().getTLI(F);
+  auto &Provider = getAnalysis<GlobalDefinedMemoryProvider>(F);
+  auto &RegInfo = Provider.get<DFRegionInfoPass>().getRegionInfo();
+  auto &AT = Provider.get<EstimateMemoryPass>().getAliasTree();
+  const auto &DT = Provider.get<DominatorTreeWrapperPass>().getDomTree();
+  auto *DFF = cast<DFFunction>(RegInfo.getTopLevelRegion());
+  auto &DI = Provider.get<DelinearizationPass>().getDelinearizeInfo();
+  auto &SE = Provider.get<ScalarEvolutionWrapperPass>().getSE();
+  DefinedMemoryInfo DefInfo;
+  ReachDFFwk ReachDefFwk(AT, TLI, RegInfo, DT, DI, SE, DL, GO, DefInfo, Info);
+  solveDataFlowUpward(&ReachDefFwk, DFF);
+  auto DefUseSetItr = ReachDefFwk.getDefInfo().find(DFF);
+  assert(DefUseSetItr != ReachDefFwk.getDefInfo().end() &&
+         "Def-use set must exist for a function!");
+  LLVM_DEBUG(dbgs() << "[GLOBAL DEFINED MEMORY]: leave " << F.getName()
+                    << "\n";);
+  return std::move(DefUseSetItr->get<DefUseSet>());
+}
+
+void GlobalDefinedMemory::analyzeRecursion(ArrayRef<CallGraphNode *> SCC,
+                                           const GlobalOptions &GO,
+                                           InterprocDefUseInfo &Info) {
+  SmallVector<Function *, 4> Functions;
+  for (auto *CGN : SCC) {
+    // Indirect calls or calls to functions without body may lead to
+    // implicit recursion which is not represented in the SCC. So, disable
+    // analysis in this case.
+    auto *F = CGN->getFunction();
+    if (!F || F->empty() || !hasFnAttr(*F, AttrKind::DirectUserCallee)) {
+      for (auto *F : Functions)
+        Info.erase(F);
+      return;
+    }
+    Functions.push_back(F);
+  }
+  if (all_of(Functions, [&Info](Function *F) { return Info.count(F); })) {
+    LLVM_DEBUG(dbgs() << "[GLOBAL DEFINED MEMORY]: reuse summaries for "
+                         "recursion\n";);
+    return;
+  }
+  // Start with summaries without side effects. Note, that may-information
+  // only grows from one iteration to another and must-information is always
+  // calculated for terminating paths through the recursion.
+  for (auto *F : Functions) {
+    Info.erase(F);
+    Info.try_emplace(F, std::make_unique<DefUseSet>());
+  }
+  bool IsChanged = true;
+  for (unsigned Iteration = 0;
+       IsChanged && Iteration < MaxRecursionIterations; ++Iteration) {
+    LLVM_DEBUG(dbgs() << "[GLOBAL DEFINED MEMORY]: recursion iteration "
+                      << Iteration << "\n";);
+    IsChanged = false;
+    for (auto *F : Functions) {
+      auto DU = analyzeFunction(*F, GO, Info);
+      auto &Summary = Info.find(F)->get<DefUseSet>();
+      if (*DU != *Summary) {
+        Summary = std::move(DU);
+        IsChanged = true;
+      }
+    }
+  }
+  if (IsChanged) {
+    // Widen summaries to unknown side effects: callers of these functions
+    // are analyzed conservatively.
+    LLVM_DEBUG(dbgs() << "[GLOBAL DEFINED MEMORY]: fixpoint is not reached, "
+                         "drop summaries for recursion\n";);
+    for (auto *F : Functions)
+      Info.erase(F);
+  }
+}
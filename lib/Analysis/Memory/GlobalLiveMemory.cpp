@@ -23,6 +23,7 @@
 //===---------------------------------------------------------------------===//
 
 #include "tsar/Analysis/Attributes.h"
+#include "tsar/Analysis/FunctionChanges.h"
 #include "tsar/Analysis/Memory/GlobalsAccess.h"
 #include "tsar/Analysis/Memory/LiveMemory.h"
 #include "tsar/Analysis/Memory/MemoryAccessUtils.h"
@@ -216,6 +217,7 @@ INITIALIZE_PASS_DEPENDENCY(GlobalDefinedMemoryWrapper)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(GlobalLiveMemoryWrapper)
 INITIALIZE_PASS_DEPENDENCY(GlobalOptionsImmutableWrapper)
+INITIALIZE_PASS_DEPENDENCY(FunctionChangeWrapper)
 INITIALIZE_PASS_END(GlobalLiveMemory, "global-live-mem",
                     "Global Live Memory Analysis", true, true)
 
@@ -227,6 +229,7 @@ void GlobalLiveMemory::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequired<GlobalLiveMemoryWrapper>();
   AU.addRequired<GlobalOptionsImmutableWrapper>();
   AU.addRequired<GlobalsAccessWrapper>();
+  AU.addRequired<FunctionChangeWrapper>();
   AU.setPreservesAll();
 }
 
@@ -242,15 +245,22 @@ bool GlobalLiveMemory::runOnModule(Module &M) {
   auto &Wrapper = getAnalysis<GlobalLiveMemoryWrapper>();
   if (!Wrapper)
     return false;
-  Wrapper->clear();
+  auto &Changes = getAnalysis<FunctionChangeWrapper>();
+  if (Changes)
+    for (auto *F : Changes->deleted())
+      Wrapper->erase(const_cast<Function *>(F));
+  else
+    Wrapper->clear();
   auto &GO = getAnalysis<GlobalOptionsImmutableWrapper>().getOptions();
   auto &CG = getAnalysis<CallGraphWrapperPass>().getCallGraph();
   std::vector<CallGraphNode *> Worklist;
   SmallPtrSet<CallGraphNode *, 32> HasExternalCalls;
   for (scc_iterator<CallGraph *> I = scc_begin(&CG); !I.isAtEnd(); ++I) {
     // TODO (kaniandr@gmail.com): implement analysis in case of recursion.
-    if (I->size() > 1)
+    if (I->size() > 1) {
+      Wrapper->clear();
       return false;
+    }
     CallGraphNode *CGN = I->front();
     auto F = CGN->getFunction();
     if (!F && !GO.NoExternalCalls)
@@ -263,12 +273,46 @@ bool GlobalLiveMemory::runOnModule(Module &M) {
         isDbgInfoIntrinsic(F->getIntrinsicID()) ||
         isMemoryMarkerIntrinsic(F->getIntrinsicID()))
       continue;
-    if (F->empty() || !hasFnAttr(*F, AttrKind::DirectUserCallee))
-      return false;
-    if (!checkCallsFrom(*CGN))
+    if (F->empty() || !hasFnAttr(*F, AttrKind::DirectUserCallee) ||
+        !checkCallsFrom(*CGN)) {
+      Wrapper->clear();
       return false;
+    }
     Worklist.push_back(CGN);
   }
+  // Live memory of a function depends on its callers, so the function should
+  // be re-analyzed if it or some of its callers (transitively) is affected by
+  // transformations. All callers of a re-analyzed function should be also
+  // re-analyzed to obtain live memory for calls of this function.
+  SmallPtrSet<Function *, 32> Reanalyze;
+  if (Changes) {
+    DenseMap<Function *, SmallVector<Function *, 4>> Callers;
+    SmallVector<Function *, 32> Stack;
+    for (auto *CGN : Worklist) {
+      auto *F = CGN->getFunction();
+      for (auto &CallRecord : *CGN)
+        if (auto *Callee = CallRecord.second->getFunction())
+          Callers[Callee].push_back(F);
+      if (Changes->isAffected(*F) || !Wrapper->count(F))
+        Stack.push_back(F);
+    }
+    while (!Stack.empty()) {
+      auto *F = Stack.pop_back_val();
+      if (!Reanalyze.insert(F).second)
+        continue;
+      for (auto &CallRecord : *CG[F])
+        if (auto *Callee = CallRecord.second->getFunction())
+          Stack.push_back(Callee);
+    }
+    Stack.append(Reanalyze.begin(), Reanalyze.end());
+    while (!Stack.empty()) {
+      auto CallerItr = Callers.find(Stack.pop_back_val());
+      if (CallerItr != Callers.end())
+        for (auto *Caller : CallerItr->second)
+          if (Reanalyze.insert(Caller).second)
+            Stack.push_back(Caller);
+    }
+  }
   GlobalLiveMemoryProvider::initialize<GlobalOptionsImmutableWrapper>(
       [&GO](GlobalOptionsImmutableWrapper &Wrapper) {
         Wrapper.setOptions(&GO);
@@ -287,6 +331,11 @@ bool GlobalLiveMemory::runOnModule(Module &M) {
     auto F = CGN->getFunction();
     if (!F || F->empty())
       continue;
+    if (Changes && !Reanalyze.count(F)) {
+      LLVM_DEBUG(dbgs() << "[GLOBAL LIVE MEMORY]: reuse summary for "
+                        << F->getName() << "\n";);
+      continue;
+    }
     LLVM_DEBUG(dbgs() << "[GLOBAL LIVE MEMORY]: analyze " << F->getName()
                       << "\n";);
     auto &Provider = getAnalysis<GlobalLiveMemoryProvider>(*F);
@@ -346,6 +395,7 @@ bool GlobalLiveMemory::runOnModule(Module &M) {
           },
           [](Instruction &, AccessInfo, AccessInfo) {});
     }
+    Wrapper->erase(F);
     Wrapper->try_emplace(F, std::move(IntraLiveInfo[TopRegion]));
   }
   LLVM_DEBUG(visitedFunctionsLog(LiveSetForCalls));
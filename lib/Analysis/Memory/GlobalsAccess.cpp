@@ -27,6 +27,7 @@
 #include "tsar/Analysis/Memory/MemoryAccessUtils.h"
 #include "tsar/Analysis/Memory/Passes.h"
 #include "tsar/Analysis/Attributes.h"
+#include "tsar/Analysis/FunctionChanges.h"
 #include <bcl/utility.h>
 #include <llvm/ADT/SCCIterator.h>
 #include <llvm/Analysis/CallGraph.h>
@@ -93,6 +94,7 @@ INITIALIZE_PASS_BEGIN(GlobalsAccessCollector, "globals-accesses",
 INITIALIZE_PASS_DEPENDENCY(CallGraphWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(GlobalsAccessWrapper)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(FunctionChangeWrapper)
 INITIALIZE_PASS_END(GlobalsAccessCollector, "globals-accesses",
   "Globals Access Collector", true, true)
 
@@ -100,6 +102,7 @@ void GlobalsAccessCollector::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequired<CallGraphWrapperPass>();
   AU.addRequired<TargetLibraryInfoWrapperPass>();
   AU.addRequired<GlobalsAccessWrapper>();
+  AU.addRequired<FunctionChangeWrapper>();
   AU.setPreservesAll();
 }
 
@@ -109,7 +112,17 @@ bool GlobalsAccessCollector::runOnModule(Module &M) {
   if (!GAP)
     return false;
   auto &Accesses{GAP.get()};
+  auto &Changes{getAnalysis<FunctionChangeWrapper>()};
   for (auto SCC{scc_begin(&CG)}; !SCC.isAtEnd(); ++SCC) {
+    // Reuse results for functions which are not affected by transformations.
+    if (Changes && none_of(*SCC, [&Changes](CallGraphNode *CGN) {
+          auto *F{CGN->getFunction()};
+          return !F || Changes->isAffected(*F);
+        }))
+      continue;
+    for (auto *CGN : *SCC)
+      if (auto *F{CGN->getFunction()})
+        Accesses.erase(F);
     bool IsChanged{false}, IsUnknown{false};
     DenseSet<GlobalVariable *> SCCAccesses;
     do {
@@ -27,13 +27,20 @@
 #include "tsar/Unparse/Utils.h"
 #endif
 #include <bcl/Equation.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/Hashing.h>
+#include <llvm/ADT/Statistic.h>
 #include <llvm/Support/Debug.h>
+#include <mutex>
 
 using namespace tsar;
 
 #undef DEBUG_TYPE
 #define DEBUG_TYPE "def-mem"
 
+STATISTIC(NumDimSolutionHit, "Number of reused solutions for dimensions");
+STATISTIC(NumDimSolutionMiss, "Number of computed solutions for dimensions");
+
 namespace {
 typedef int64_t ColumnT;
 typedef int64_t ValueT;
@@ -85,6 +92,181 @@ bool difference(const Dimension &D, const Dimension &I,
   return true;
 }
 
+/// Solution for a pair of dimensions of collapsed locations.
+struct DimSolution {
+  /// This is `true` if dimensions have no common elements.
+  bool IsEmpty = true;
+  /// This is `false` if Threshold is exceeded while the left complement
+  /// is calculated.
+  bool IsLeftExact = true;
+  /// This is `false` if Threshold is exceeded while the right complement
+  /// is calculated.
+  bool IsRightExact = true;
+  Dimension Intersection;
+  llvm::SmallVector<Dimension, 3> ComplLeft;
+  llvm::SmallVector<Dimension, 3> ComplRight;
+};
+
+/// Calculate intersection of two dimensions and complements of
+/// each dimension to this intersection.
+DimSolution solve(const Dimension &Left, const Dimension &Right,
+                  std::size_t Threshold) {
+  typedef milp::BAEquation<ColumnT, ValueT> BAEquation;
+  typedef BAEquation::Monom Monom;
+  typedef milp::BinomialSystem<ColumnT, ValueT, 0, 0, 1> LinearSystem;
+  typedef std::pair<ValueT, ValueT> VarRange;
+  DimSolution Res;
+  ColumnInfo Info;
+  // We guarantee that K1 and K2 will not be equal to 0.
+  assert(Left.Step > 0 && Right.Step > 0 && "Steps must be positive!");
+  assert(Left.TripCount > 0 && Right.TripCount > 0 &&
+      "Trip count must be positive!");
+  ValueT L1 = Left.Start, K1 = Left.Step;
+  ValueT L2 = Right.Start, K2 = Right.Step;
+  VarRange XRange(0, Left.TripCount - 1), YRange(0, Right.TripCount - 1);
+  LinearSystem System;
+  System.push_back(Monom(0, K1), Monom(1, -K2), L2 - L1);
+  System.instantiate(Info);
+  auto SolutionNumber = System.solve<ColumnInfo, false>(Info);
+  if (SolutionNumber == 0)
+    return Res;
+  auto &Solution = System.getSolution();
+  auto &LineX = Solution[0], &LineY = Solution[1];
+  // B will be equal to 0 only if K1 is equal to 0 but K1 is always positive.
+  ValueT A = LineX.Constant, B = -LineX.RHS.Value;
+  // D will be equal to 0 only if K2 is equal to 0 but K2 is always positive.
+  ValueT C = LineY.Constant, D = -LineY.RHS.Value;
+  assert(B > 0 && "B must be positive!");
+  ValueT TXmin = std::ceil((XRange.first - A) / double(B));
+  ValueT TXmax = std::floor((XRange.second - A) / double(B));
+  assert(D > 0 && "D must be positive!");
+  ValueT TYmin = std::ceil((YRange.first - C) / double(D));
+  ValueT TYmax = std::floor((YRange.second - C) / double(D));
+  ValueT Tmin = std::max(TXmin, TYmin);
+  ValueT Tmax = std::min(TXmax, TYmax);
+  if (Tmax < Tmin)
+    return Res;
+  ValueT Shift = Tmin;
+  Tmin = 0;
+  Tmax -= Shift;
+  ValueT Step = K1 * B;
+  ValueT Start = (K1 * A + L1) + Step * Shift;
+  auto &Intersection = Res.Intersection;
+  Intersection.Start = Start;
+  Intersection.Step = Step;
+  Intersection.TripCount = Tmax + 1;
+  Intersection.DimSize = Left.DimSize;
+  assert(Start >= 0 && "Start must be non-negative!");
+  assert(Step > 0 && "Step must be positive!");
+  assert(Intersection.TripCount > 0 && "Trip count must be non-negative!");
+  Res.IsEmpty = false;
+  Res.IsLeftExact = difference(Left, Intersection, Res.ComplLeft, Threshold);
+  Res.IsRightExact =
+      difference(Right, Intersection, Res.ComplRight, Threshold);
+  return Res;
+}
+
+/// Normalized pair of dimensions which is used to memoize solutions.
+///
+/// A solution does not depend on the size of a dimension and it is invariant
+/// under a shift of both dimensions, so the smallest start is subtracted
+/// from starts and sizes are ignored.
+struct DimPairKey {
+  uint64_t LeftStart;
+  uint64_t LeftStep;
+  uint64_t LeftTripCount;
+  uint64_t RightStart;
+  uint64_t RightStep;
+  uint64_t RightTripCount;
+  std::size_t Threshold;
+
+  bool operator==(const DimPairKey &Other) const {
+    return LeftStart == Other.LeftStart && LeftStep == Other.LeftStep &&
+           LeftTripCount == Other.LeftTripCount &&
+           RightStart == Other.RightStart && RightStep == Other.RightStep &&
+           RightTripCount == Other.RightTripCount &&
+           Threshold == Other.Threshold;
+  }
+};
+
+struct DimPairKeyInfo {
+  // Steps are always positive, so zero step marks special keys.
+  static DimPairKey getEmptyKey() { return {0, 0, 0, 0, 0, 0, 0}; }
+  static DimPairKey getTombstoneKey() { return {0, 0, 0, 0, 0, 0, 1}; }
+  static unsigned getHashValue(const DimPairKey &K) {
+    return llvm::hash_combine(K.LeftStart, K.LeftStep, K.LeftTripCount,
+                              K.RightStart, K.RightStep, K.RightTripCount,
+                              K.Threshold);
+  }
+  static bool isEqual(const DimPairKey &LHS, const DimPairKey &RHS) {
+    return LHS == RHS;
+  }
+};
+
+/// Bounded thread-safe storage of already calculated solutions.
+///
+/// The whole storage is dropped when it becomes full. The same pairs of
+/// dimensions are usually intersected in a short period of time while
+/// a single function is analyzed, so there is no need in a more precise
+/// replacement policy.
+class DimSolutionCache {
+  enum : unsigned { MaxSize = 4096 };
+public:
+  /// Return solution for a specified pair of dimensions, calculate it if it
+  /// has not been calculated yet.
+  DimSolution get(const Dimension &Left, const Dimension &Right,
+                  std::size_t Threshold) {
+    auto Base = std::min(Left.Start, Right.Start);
+    DimPairKey Key{Left.Start - Base, Left.Step, Left.TripCount,
+                   Right.Start - Base, Right.Step, Right.TripCount, Threshold};
+    DimSolution Res;
+    bool IsCached = false;
+    {
+      std::lock_guard<std::mutex> Lock(mMutex);
+      auto I = mSolutions.find(Key);
+      if (I != mSolutions.end()) {
+        Res = I->second;
+        IsCached = true;
+      }
+    }
+    if (IsCached) {
+      ++NumDimSolutionHit;
+    } else {
+      ++NumDimSolutionMiss;
+      Dimension NormLeft(Left), NormRight(Right);
+      NormLeft.Start = Key.LeftStart;
+      NormLeft.DimSize = 0;
+      NormRight.Start = Key.RightStart;
+      NormRight.DimSize = 0;
+      Res = solve(NormLeft, NormRight, Threshold);
+      std::lock_guard<std::mutex> Lock(mMutex);
+      if (mSolutions.size() >= MaxSize)
+        mSolutions.clear();
+      mSolutions.try_emplace(Key, Res);
+    }
+    auto restore = [Base, &Left](Dimension &D) {
+      D.Start += Base;
+      D.DimSize = Left.DimSize;
+    };
+    restore(Res.Intersection);
+    for (auto &D : Res.ComplLeft)
+      restore(D);
+    for (auto &D : Res.ComplRight)
+      restore(D);
+    return Res;
+  }
+
+private:
+  std::mutex mMutex;
+  llvm::DenseMap<DimPairKey, DimSolution, DimPairKeyInfo> mSolutions;
+};
+
+DimSolution solveCached(const Dimension &Left, const Dimension &Right,
+                        std::size_t Threshold) {
+  static DimSolutionCache Cache;
+  return Cache.get(Left, Right, Threshold);
+}
+
 #ifndef NDEBUG
 void printSolutionInfo(llvm::raw_ostream &OS,
     const MemoryLocationRange &Int,
@@ -226,10 +408,6 @@ llvm::Optional<MemoryLocationRange> intersect(
     llvm::SmallVectorImpl<MemoryLocationRange> *LC,
     llvm::SmallVectorImpl<MemoryLocationRange> *RC,
     unsigned Threshold) {
-  typedef milp::BAEquation<ColumnT, ValueT> BAEquation;
-  typedef BAEquation::Monom Monom;
-  typedef milp::BinomialSystem<ColumnT, ValueT, 0, 0, 1> LinearSystem;
-  typedef std::pair<ValueT, ValueT> VarRange;
   typedef MemoryLocationRange::LocKind LocKind;
   assert(LHS.Ptr && RHS.Ptr &&
       "Pointers of intersected memory locations must not be null!");
@@ -271,66 +449,21 @@ llvm::Optional<MemoryLocationRange> intersect(
     auto RightEnd = Right.Start + Right.Step * (Right.TripCount - 1);
     if (LeftEnd < Right.Start || RightEnd < Left.Start)
       return llvm::None;
-    ColumnInfo Info;
-    // We guarantee that K1 and K2 will not be equal to 0.
-    assert(Left.Step > 0 && Right.Step > 0 && "Steps must be positive!");
-    assert(Left.TripCount > 0 && Right.TripCount > 0 &&
-        "Trip count must be positive!");
-    ValueT L1 = Left.Start, K1 = Left.Step;
-    ValueT L2 = Right.Start, K2 = Right.Step;
-    VarRange XRange(0, Left.TripCount - 1), YRange(0, Right.TripCount - 1);
-    LinearSystem System;
-    System.push_back(Monom(0, K1), Monom(1, -K2), L2 - L1);
-    System.instantiate(Info);
-    auto SolutionNumber = System.solve<ColumnInfo, false>(Info);
-    if (SolutionNumber == 0)
-      return llvm::None;
-    auto &Solution = System.getSolution();
-    auto &LineX = Solution[0], &LineY = Solution[1];
-    // B will be equal to 0 only if K1 is equal to 0 but K1 is always positive.
-    ValueT A = LineX.Constant, B = -LineX.RHS.Value;
-    // D will be equal to 0 only if K2 is equal to 0 but K2 is always positive.
-    ValueT C = LineY.Constant, D = -LineY.RHS.Value;
-    assert(B > 0 && "B must be positive!");
-    ValueT TXmin = std::ceil((XRange.first - A) / double(B));
-    ValueT TXmax = std::floor((XRange.second - A) / double(B));
-    assert(D > 0 && "D must be positive!");
-    ValueT TYmin = std::ceil((YRange.first - C) / double(D));
-    ValueT TYmax = std::floor((YRange.second - C) / double(D));
-    ValueT Tmin = std::max(TXmin, TYmin);
-    ValueT Tmax = std::min(TXmax, TYmax);
-    if (Tmax < Tmin)
+    auto Solution = solveCached(Left, Right, Threshold);
+    if (Solution.IsEmpty)
       return llvm::None;
-    ValueT Shift = Tmin;
-    Tmin = 0;
-    Tmax -= Shift;
-    ValueT Step = K1 * B;
-    ValueT Start = (K1 * A + L1) + Step * Shift;
-    auto &Intersection = Int.DimList[I];
-    Intersection.Start = Start;
-    Intersection.Step = Step;
-    Intersection.TripCount = Tmax + 1;
-    Intersection.DimSize = Left.DimSize;
-    assert(Start >= 0 && "Start must be non-negative!");
-    assert(Step > 0 && "Step must be positive!");
-    assert(Intersection.TripCount > 0 && "Trip count must be non-negative!");
+    Int.DimList[I] = Solution.Intersection;
     if (LC) {
-      llvm::SmallVector<Dimension, 3> ComplLeft;
-      if (!difference(Left, Intersection, ComplLeft, Threshold)) {
+      if (!Solution.IsLeftExact)
         return MemoryLocationRange();
-      } else {
-        for (auto &Comp : ComplLeft)
-          LC->emplace_back(LHS).DimList[I] = Comp;
-      }
+      for (auto &Comp : Solution.ComplLeft)
+        LC->emplace_back(LHS).DimList[I] = Comp;
     }
     if (RC) {
-      llvm::SmallVector<Dimension, 3> ComplRight;
-      if (!difference(Right, Intersection, ComplRight, Threshold)) {
+      if (!Solution.IsRightExact)
         return MemoryLocationRange();
-      } else {
-        for (auto &Comp : ComplRight)
-          RC->emplace_back(RHS).DimList[I] = Comp;
-      }
+      for (auto &Comp : Solution.ComplRight)
+        RC->emplace_back(RHS).DimList[I] = Comp;
     }
   }
   LLVM_DEBUG(printSolutionInfo(llvm::dbgs(), Int, LC, RC));
@@ -47,5 +47,6 @@ void llvm::initializeMemoryAnalysis(PassRegistry &Registry) {
   initializeGlobalLiveMemoryPass(Registry);
   initializeDIArrayAccessWrapperPass(Registry);
   initializeAllocasAAWrapperPassPass(Registry);
+  initializeTieredAAWrapperPassPass(Registry);
   initializeGlobalsAccessWrapperPass(Registry);
 }
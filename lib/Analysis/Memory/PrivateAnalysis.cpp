@@ -57,8 +57,10 @@
 #include "llvm/IR/InstIterator.h"
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Operator.h>
+#include <llvm/Support/CommandLine.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/Debug.h>
+#include <llvm/Support/ThreadPool.h>
 #include <bcl/utility.h>
 
 using namespace llvm;
@@ -71,6 +73,11 @@ using bcl::operator "" _b;
 
 MEMORY_TRAIT_STATISTIC(NumTraits)
 
+static cl::opt<unsigned> PrivateJobs(
+    "private-jobs", cl::init(1), cl::Hidden,
+    cl::desc("Number of threads to analyze independent loop nests "
+             "(0 means the number of available hardware threads)"));
+
 char PrivateRecognitionPass::ID = 0;
 INITIALIZE_PASS_IN_GROUP_BEGIN(PrivateRecognitionPass, "private",
   "Private Variable Analysis", false, true,
@@ -91,12 +98,51 @@ INITIALIZE_PASS_IN_GROUP_END(PrivateRecognitionPass, "private",
 namespace tsar {
 namespace detail {
 /// Internal representation of cache which stores dependence analysis results.
+///
+/// Pairs of memory accesses are enumerated once for the outermost loop in
+/// a nest. Each pair stores loop-independent information only (results of
+/// alias and dependence analysis), so results for inner loops are obtained
+/// by projection of these pairs onto an inner loop without additional queries.
 struct DependenceCache {
   using SrcDstPair = std::pair<Instruction *, Instruction *>;
   using DependenceConfusedPair =
     std::pair<std::unique_ptr<Dependence>, unsigned short>;
   using CacheT = DenseMap<SrcDstPair, DependenceConfusedPair>;
+
+  /// Loop-independent description of a pair of memory accesses.
+  struct AccessPair {
+    enum Kind : uint8_t {
+      /// Both instructions access memory which can not be described with
+      /// a single location, `Memory` contains locations which are accessed
+      /// in both instructions.
+      Unknown,
+      /// Memory accessed in a destination instruction can not be described
+      /// with a single location, it may access `SrcLoc`.
+      UnknownDst,
+      /// Both accesses are loads or stores, `Dep` is a result of dependence
+      /// analysis.
+      LoadStore
+    };
+
+    Instruction *Src;
+    Instruction *Dst;
+    Kind K;
+    trait::Dependence::Flag Flag = trait::Dependence::No;
+    MemoryLocation SrcLoc;
+    MemoryLocation DstLoc;
+    SmallVector<const EstimateMemory *, 2> Memory;
+    SmallVector<Value *, 2> Causes;
+    Dependence *Dep = nullptr;
+    unsigned short ConfusedLevels = 0;
+  };
+
   CacheT Impl;
+
+  /// The outermost loop pairs of accesses have been collected for.
+  Loop *Outermost = nullptr;
+
+  /// Pairs of memory accesses in the outermost loop.
+  std::vector<AccessPair> Pairs;
 };
 }
 }
@@ -124,11 +170,71 @@ bool PrivateRecognitionPass::runOnFunction(Function &F) {
   GraphNumbering<const AliasNode *> Numbers;
   numberGraph(mAliasTree, &Numbers);
   AliasTreeRelation AliasSTR(mAliasTree);
-  DependenceCache Cache;
-  resolveCandidats(Numbers, AliasSTR, DFF, Cache);
+  TimeTraceSizes Trace("PrivateRecognition", F);
+  SmallVector<DFRegion *, 16> Nests;
+  collectLoopNests(DFF, Nests);
+  unsigned Jobs = PrivateJobs;
+#ifndef NDEBUG
+  // Debug output for different loop nests must not be interleaved.
+  if (DebugFlag && isCurrentDebugType(DEBUG_TYPE))
+    Jobs = 1;
+#endif
+  if (Jobs == 1 || Nests.size() < 2) {
+    DependenceCache Cache;
+    resolveCandidats(Numbers, AliasSTR, DFF, Cache);
+    Trace.add("dependence pairs", Cache.Impl.size());
+    return false;
+  }
+  // Loop nests are analyzed in parallel, so all shared data must not be
+  // updated during the analysis. Results for all loops are allocated in
+  // advance and alias tree is not lazily updated later.
+  reserveResults(DFF, mPrivates);
+  settleAliasTree(*mAliasTree);
+  std::vector<DependenceCache> Caches(Nests.size());
+  ThreadPool Pool(hardware_concurrency(Jobs));
+  for (std::size_t I = 0, EI = Nests.size(); I < EI; ++I)
+    Pool.async([this, &Numbers, &AliasSTR, &Nests, &Caches, I]() {
+      resolveCandidats(Numbers, AliasSTR, Nests[I], Caches[I]);
+    });
+  Pool.wait();
+  std::size_t PairNum = 0;
+  for (auto &Cache : Caches)
+    PairNum += Cache.Impl.size();
+  Trace.add("dependence pairs", PairNum);
   return false;
 }
 
+void PrivateRecognitionPass::collectLoopNests(DFRegion *R,
+    SmallVectorImpl<DFRegion *> &Nests) {
+  for (auto I = R->region_begin(), E = R->region_end(); I != E; ++I)
+    if (isa<DFLoop>(*I))
+      Nests.push_back(*I);
+    else
+      collectLoopNests(*I, Nests);
+}
+
+void PrivateRecognitionPass::reserveResults(DFRegion *R, PrivateInfo &Info) {
+  if (auto *L = dyn_cast<DFLoop>(R))
+    Info.try_emplace(L);
+  for (auto I = R->region_begin(), E = R->region_end(); I != E; ++I)
+    reserveResults(*I, Info);
+}
+
+const EstimateMemory *
+PrivateRecognitionPass::findMemory(const MemoryLocation &Loc) {
+  std::lock_guard<std::mutex> Lock(mSharedAnalysisLock);
+  return mAliasTree->find(Loc);
+}
+
+void PrivateRecognitionPass::settleAliasTree(const AliasTree &AT) {
+  for (auto &N : AT) {
+    N.getParent(AT);
+    if (auto *EN = dyn_cast<AliasEstimateNode>(&N))
+      for (auto &EM : *EN)
+        EM.getAliasNode(AT);
+  }
+}
+
 namespace {
 struct DistanceInfo {
   enum Apply : uint8_t {
@@ -161,8 +267,9 @@ struct DistanceInfo {
   };
 
   DistanceInfo() = default;
-  DistanceInfo(const Dependence &D, unsigned L, Apply T, ScalarEvolution &SE)
-      : Dep(&D), Level(L), Transform(T), SE(&SE) {
+  DistanceInfo(const Dependence &D, unsigned L, Apply T, ScalarEvolution &SE,
+               std::mutex &SELock)
+      : Dep(&D), Level(L), Transform(T), SE(&SE), SELock(&SELock) {
     assert(Level <= Dep->getLevels() && "Level out of range!");
   }
 
@@ -170,6 +277,9 @@ struct DistanceInfo {
   unsigned Level = 0;
   Apply Transform = NotChange;
   ScalarEvolution *SE = nullptr;
+
+  /// Guard for scalar evolution which may be shared between threads.
+  std::mutex *SELock = nullptr;
 };
 }
 
@@ -200,6 +310,7 @@ public:
       if (!(mDep->mFlags.get<Trait>() & trait::Dependence::UnknownDistance)) {
         trait::IRDependence::DistanceVector Distances (
             mDep->mDists.get<Trait>().size());
+        std::lock_guard<std::mutex> Lock(*mSELock);
         auto LevelItr = mDep->mDists.get<Trait>().begin();
         auto LevelItrE = mDep->mDists.get<Trait>().end();
         unsigned Idx = 0;
@@ -224,6 +335,7 @@ public:
     DependenceImp *mDep;
     TraitSet *mSet;
     ScalarEvolution *mSE;
+    std::mutex *mSELock;
   };
 
   /// Returns descriptor.
@@ -266,6 +378,9 @@ private:
       if (mDep->mKnownDistanceLevel.get<Trait>() &&
           DistLevel > mDist.Level + *mDep->mKnownDistanceLevel.get<Trait>())
         DistLevel = mDist.Level + *mDep->mKnownDistanceLevel.get<Trait>();
+      std::unique_lock<std::mutex> Lock;
+      if (mDist.Transform != DistanceInfo::NotChange)
+        Lock = std::unique_lock<std::mutex>(*mDist.SELock);
       for (unsigned I = mDist.Level; I < DistLevel; ++I) {
         auto *Dist = mDist.Dep->getDistance(I);
         if (!Dist) {
@@ -482,7 +597,7 @@ void PrivateRecognitionPass::collectHeaderAccesses(
           unsigned, AccessInfo R, AccessInfo W) {
         if (R == AccessInfo::No &&  W == AccessInfo::No)
           return;
-        auto *EM = mAliasTree->find(Loc);
+        auto *EM = findMemory(Loc);
         assert(EM && "Estimate memory location must not be null!");
         auto EMTraitItr = ExplicitAccesses.find(EM);
         while (EMTraitItr == ExplicitAccesses.end()) {
@@ -515,6 +630,8 @@ void PrivateRecognitionPass::resolveCandidats(
       }
       dbgs() << "\n";
     );
+    // If loop nests are analyzed in parallel the result has been already
+    // allocated, so `mPrivates` is not updated here.
     auto PrivInfo = mPrivates.try_emplace(L);
     auto DefItr = mDefInfo->find(L);
     assert(DefItr != mDefInfo->end() &&
@@ -557,8 +674,8 @@ void PrivateRecognitionPass::insertDependence(const Dependence &Dep,
     Dptr.set<trait::Flow, trait::Anti, trait::Output>();
     trait::Dependence::Flag Flag = trait::Dependence::ConfusedCause |
       trait::Dependence::LoadStoreCause | trait::Dependence::May;
-    updateDependence(mAliasTree->find(Src), Dptr, Flag, DistanceInfo{}, Deps);
-    updateDependence(mAliasTree->find(Dst), Dptr, Flag, DistanceInfo{}, Deps);
+    updateDependence(findMemory(Src), Dptr, Flag, DistanceInfo{}, Deps);
+    updateDependence(findMemory(Dst), Dptr, Flag, DistanceInfo{}, Deps);
     return;
   }
   for (unsigned OuterDepth =
@@ -579,7 +696,8 @@ void PrivateRecognitionPass::insertDependence(const Dependence &Dep,
   }
   assert((Dep.isOutput() || Dep.isAnti() || Dep.isFlow()) &&
     "Unknown kind of dependency!");
-  DistanceInfo Dist{Dep, L.getLoopDepth(), DistanceInfo::NotChange, *mSE};
+  DistanceInfo Dist{Dep, L.getLoopDepth(), DistanceInfo::NotChange, *mSE,
+                    mSharedAnalysisLock};
   DependenceImp::Descriptor Dptr;
   if (Dep.isOutput()) {
     if (Dir == Dependence::DVEntry::GT || Dir == Dependence::DVEntry::GE)
@@ -606,138 +724,180 @@ void PrivateRecognitionPass::insertDependence(const Dependence &Dep,
     Dptr.set<trait::Flow, trait::Anti>();
     Dist.Transform |= DistanceInfo::Extend;
   }
-  updateDependence(mAliasTree->find(Src), Dptr,
+  updateDependence(findMemory(Src), Dptr,
                    trait::Dependence::LoadStoreCause | Flag, std::move(Dist),
                    Deps);
-  updateDependence(mAliasTree->find(Dst), Dptr,
+  updateDependence(findMemory(Dst), Dptr,
                    trait::Dependence::LoadStoreCause | Flag, std::move(Dist),
                    Deps);
 }
 
-void PrivateRecognitionPass::collectDependencies(Loop *L, DependenceMap &Deps,
+void PrivateRecognitionPass::collectAccessPairs(Loop *L,
     DependenceCache &Cache) {
   auto &AA = mAliasTree->getAliasAnalysis();
+  Cache.Outermost = L;
+  Cache.Pairs.clear();
   std::vector<Instruction *> LoopInsts;
   for (auto *BB : L->getBlocks())
     for (auto &I : *BB)
-      LoopInsts.push_back(&I);
+      if (I.mayReadOrWriteMemory())
+        LoopInsts.push_back(&I);
   for (auto SrcItr = LoopInsts.begin(), EndItr = LoopInsts.end();
        SrcItr != EndItr; ++SrcItr) {
-    if (!(**SrcItr).mayReadOrWriteMemory())
-      continue;
     auto Src = getLoadOrStoreLocation(*SrcItr);
     if (!Src.Ptr) {
       if (auto II = dyn_cast<IntrinsicInst>(*SrcItr))
         if (isMemoryMarkerIntrinsic(II->getIntrinsicID()))
           continue;
       for (auto DstItr = SrcItr; DstItr != EndItr; ++DstItr) {
-        if (!(**DstItr).mayReadOrWriteMemory())
-          continue;
         if (auto II = dyn_cast<IntrinsicInst>(*DstItr))
           if (isMemoryMarkerIntrinsic(II->getIntrinsicID()))
             continue;
-        trait::Dependence::Flag Flag = trait::Dependence::May |
+        DependenceCache::AccessPair Pair{*SrcItr, *DstItr,
+                                         DependenceCache::AccessPair::Unknown};
+        Pair.Flag = trait::Dependence::May |
           trait::Dependence::UnknownDistance |
           (!isa<CallBase>(*SrcItr) && !isa<CallBase>(*DstItr)
              ? trait::Dependence::UnknownCause
              : trait::Dependence::CallCause);
-        DependenceImp::Descriptor Dptr;
-        Dptr.set<trait::Flow, trait::Anti, trait::Output>();
-        SmallVector<Value *, 2> Causes;
         if (isa<CallBase>(*SrcItr))
-          Causes.push_back(*SrcItr);
+          Pair.Causes.push_back(*SrcItr);
         if (isa<CallBase>(*DstItr))
-          Causes.push_back(*DstItr);
-        auto insertUnknownDep =
-          [this, &AA, &SrcItr, &DstItr, &Dptr, Flag, &Causes, &Deps](
-            Instruction &, MemoryLocation &&Loc, unsigned,
-            AccessInfo R, AccessInfo W) {
+          Pair.Causes.push_back(*DstItr);
+        auto collectMemory = [this, &AA, &Pair](Instruction &,
+            MemoryLocation &&Loc, unsigned, AccessInfo R, AccessInfo W) {
           if (R == AccessInfo::No && W == AccessInfo::No)
             return;
-          if (AA.getModRefInfo(*SrcItr, Loc) == ModRefInfo::NoModRef)
-            return;
-          if (AA.getModRefInfo(*DstItr, Loc) == ModRefInfo::NoModRef)
-            return;
-          updateDependence(mAliasTree->find(Loc), Dptr, Flag, DistanceInfo{},
-                           Deps, Causes);
+          {
+            std::lock_guard<std::mutex> Lock(mSharedAnalysisLock);
+            if (AA.getModRefInfo(Pair.Src, Loc) == ModRefInfo::NoModRef)
+              return;
+            if (AA.getModRefInfo(Pair.Dst, Loc) == ModRefInfo::NoModRef)
+              return;
+          }
+          Pair.Memory.push_back(findMemory(Loc));
         };
         auto stab = [](Instruction &, AccessInfo, AccessInfo) {};
-        LLVM_DEBUG(dbgs() << "[PRIVATE]: conservatively assume dependence: ";
-                   (**SrcItr).print(dbgs()); dbgs() << "\n";
-                   (**DstItr).print(dbgs()); dbgs() << "\n");
-        for_each_memory(**SrcItr, *mTLI, insertUnknownDep, stab);
-        for_each_memory(**DstItr, *mTLI, insertUnknownDep, stab);
+        for_each_memory(**SrcItr, *mTLI, collectMemory, stab);
+        for_each_memory(**DstItr, *mTLI, collectMemory, stab);
+        Cache.Pairs.push_back(std::move(Pair));
       }
     } else {
       for (auto DstItr = SrcItr; DstItr != EndItr; ++DstItr) {
         auto Dst = getLoadOrStoreLocation(*DstItr);
         if (!Dst.Ptr) {
-          if (!(**DstItr).mayReadOrWriteMemory())
-            continue;
           if (auto II = dyn_cast<IntrinsicInst>(*DstItr))
             if (isMemoryMarkerIntrinsic(II->getIntrinsicID()))
               continue;
+          std::unique_lock<std::mutex> Lock(mSharedAnalysisLock);
           if (AA.getModRefInfo(*DstItr, Src) == ModRefInfo::NoModRef)
             continue;
-          trait::Dependence::Flag Flag = trait::Dependence::May |
+          Lock.unlock();
+          DependenceCache::AccessPair Pair{
+              *SrcItr, *DstItr, DependenceCache::AccessPair::UnknownDst};
+          Pair.Flag = trait::Dependence::May |
             trait::Dependence::UnknownDistance |
             (!isa<CallBase>(*DstItr) ? trait::Dependence::UnknownCause :
               trait::Dependence::CallCause);
-          DependenceImp::Descriptor Dptr;
-          Dptr.set<trait::Flow, trait::Anti, trait::Output>();
-          LLVM_DEBUG(dbgs() << "[PRIVATE]: conservatively assume dependence: ";
-                     (**SrcItr).print(dbgs()); dbgs() << "\n";
-                     (**DstItr).print(dbgs()); dbgs() << "\n");
-          updateDependence(mAliasTree->find(Src), Dptr, Flag, DistanceInfo{},
-                           Deps, isa<CallBase>(*DstItr) ? *DstItr : nullptr);
+          Pair.SrcLoc = Src;
+          Pair.Causes.push_back(isa<CallBase>(*DstItr) ? *DstItr : nullptr);
+          Cache.Pairs.push_back(std::move(Pair));
         } else {
           if (!(*SrcItr)->mayWriteToMemory() &&
               !(*DstItr)->mayWriteToMemory()) {
             LLVM_DEBUG(dbgs() << "[PRIVATE]: ignore input dependence\n");
             continue;
           }
+          DependenceCache::AccessPair Pair{
+              *SrcItr, *DstItr, DependenceCache::AccessPair::LoadStore};
+          Pair.SrcLoc = Src;
+          Pair.DstLoc = Dst;
           auto CacheItr = Cache.Impl.find(std::make_pair(*SrcItr, *DstItr));
-          unsigned short ConfusedLevels;
-          Dependence *Dep = nullptr;
           if (CacheItr != Cache.Impl.end()) {
-            Dep = CacheItr->second.first.get();
-            ConfusedLevels = CacheItr->second.second;
+            Pair.Dep = CacheItr->second.first.get();
+            Pair.ConfusedLevels = CacheItr->second.second;
           } else {
-            auto D = mDepInfo->depends(*SrcItr, *DstItr, true, &ConfusedLevels);
-            Dep = D.get();
+            std::unique_lock<std::mutex> Lock(mSharedAnalysisLock);
+            auto D = mDepInfo->depends(*SrcItr, *DstItr, true,
+                                       &Pair.ConfusedLevels);
+            Lock.unlock();
+            Pair.Dep = D.get();
             Cache.Impl.try_emplace(std::make_pair(*SrcItr, *DstItr),
-              std::move(D), ConfusedLevels);
-          }
-          if (Dep) {
-            LLVM_DEBUG(
-              dbgs() << "[PRIVATE]: dependence found: ";
-              Dep->dump(dbgs());
-              (**SrcItr).print(dbgs()); dbgs() << "\n";
-              (**DstItr).print(dbgs()); dbgs() << "\n";
-            );
-            // Do not use Dependence::isLoopIndependent() to check loop
-            // independent dependencies. This method returns `may` instead of
-            // `must`. This means that if it returns `true` than dependency
-            // may be loop-carried or may arise inside a single iteration.
-            insertDependence(*Dep, Src, Dst, trait::Dependence::No, *L, Deps);
-          } else if (L->getLoopDepth() <= ConfusedLevels) {
-            LLVM_DEBUG(dbgs() << "[PRIVATE]: assume confused dependence"
-              " (confused levels " << ConfusedLevels << ")\n");
-            DependenceImp::Descriptor Dptr;
-            Dptr.set<trait::Flow, trait::Anti, trait::Output>();
-            trait::Dependence::Flag Flag = trait::Dependence::ConfusedCause |
-              trait::Dependence::LoadStoreCause | trait::Dependence::May;
-            updateDependence(mAliasTree->find(Src), Dptr, Flag, DistanceInfo{},
-                             Deps);
-            updateDependence(mAliasTree->find(Dst), Dptr, Flag, DistanceInfo{},
-                             Deps);
+              std::move(D), Pair.ConfusedLevels);
           }
+          if (Pair.Dep || Pair.ConfusedLevels > 0)
+            Cache.Pairs.push_back(std::move(Pair));
         }
       }
     }
   }
 }
 
+void PrivateRecognitionPass::collectDependencies(Loop *L, DependenceMap &Deps,
+    DependenceCache &Cache) {
+  auto *Outermost = L;
+  while (auto *Parent = Outermost->getParentLoop())
+    Outermost = Parent;
+  if (Cache.Outermost != Outermost)
+    collectAccessPairs(Outermost, Cache);
+  bool IsOutermost = L == Outermost;
+  for (auto &Pair : Cache.Pairs) {
+    if (!IsOutermost && (!L->contains(Pair.Src) || !L->contains(Pair.Dst)))
+      continue;
+    switch (Pair.K) {
+    case DependenceCache::AccessPair::Unknown: {
+      LLVM_DEBUG(dbgs() << "[PRIVATE]: conservatively assume dependence: ";
+                 Pair.Src->print(dbgs()); dbgs() << "\n";
+                 Pair.Dst->print(dbgs()); dbgs() << "\n");
+      for (auto *EM : Pair.Memory) {
+        DependenceImp::Descriptor Dptr;
+        Dptr.set<trait::Flow, trait::Anti, trait::Output>();
+        updateDependence(EM, Dptr, Pair.Flag, DistanceInfo{}, Deps,
+                         Pair.Causes);
+      }
+      break;
+    }
+    case DependenceCache::AccessPair::UnknownDst: {
+      DependenceImp::Descriptor Dptr;
+      Dptr.set<trait::Flow, trait::Anti, trait::Output>();
+      LLVM_DEBUG(dbgs() << "[PRIVATE]: conservatively assume dependence: ";
+                 Pair.Src->print(dbgs()); dbgs() << "\n";
+                 Pair.Dst->print(dbgs()); dbgs() << "\n");
+      updateDependence(findMemory(Pair.SrcLoc), Dptr, Pair.Flag,
+                       DistanceInfo{}, Deps, Pair.Causes);
+      break;
+    }
+    case DependenceCache::AccessPair::LoadStore:
+      if (Pair.Dep) {
+        LLVM_DEBUG(
+          dbgs() << "[PRIVATE]: dependence found: ";
+          Pair.Dep->dump(dbgs());
+          Pair.Src->print(dbgs()); dbgs() << "\n";
+          Pair.Dst->print(dbgs()); dbgs() << "\n";
+        );
+        // Do not use Dependence::isLoopIndependent() to check loop
+        // independent dependencies. This method returns `may` instead of
+        // `must`. This means that if it returns `true` than dependency
+        // may be loop-carried or may arise inside a single iteration.
+        insertDependence(*Pair.Dep, Pair.SrcLoc, Pair.DstLoc,
+                         trait::Dependence::No, *L, Deps);
+      } else if (L->getLoopDepth() <= Pair.ConfusedLevels) {
+        LLVM_DEBUG(dbgs() << "[PRIVATE]: assume confused dependence"
+          " (confused levels " << Pair.ConfusedLevels << ")\n");
+        DependenceImp::Descriptor Dptr;
+        Dptr.set<trait::Flow, trait::Anti, trait::Output>();
+        trait::Dependence::Flag Flag = trait::Dependence::ConfusedCause |
+          trait::Dependence::LoadStoreCause | trait::Dependence::May;
+        updateDependence(findMemory(Pair.SrcLoc), Dptr, Flag,
+                         DistanceInfo{}, Deps);
+        updateDependence(findMemory(Pair.DstLoc), Dptr, Flag,
+                         DistanceInfo{}, Deps);
+      }
+      break;
+    }
+  }
+}
+
 void PrivateRecognitionPass::resolveAccesses(Loop *L, const DFNode *LatchNode,
     const DFNode *ExitNode, const tsar::DefUseSet &DefUse,
     const tsar::LiveSet &LS, const DependenceMap &Deps,
@@ -762,7 +922,7 @@ void PrivateRecognitionPass::resolveAccesses(Loop *L, const DFNode *LatchNode,
   assert(ExitDF && "List of must/may defined locations must not be null!");
   const DefinitionInfo &ExitingDefs = ExitDF->getOut();
   for (const auto &Loc : DefUse.getExplicitAccesses()) {
-    const EstimateMemory *Base = mAliasTree->find(Loc);
+    const EstimateMemory *Base = findMemory(Loc);
     assert(Base && "Estimate memory location must not be null!");
     auto Pair = ExplicitAccesses.insert(std::make_pair(Base, nullptr));
     if (Pair.second) {
@@ -794,9 +954,11 @@ void PrivateRecognitionPass::resolveAccesses(Loop *L, const DFNode *LatchNode,
       if (!LS.getOut().overlap(Loc) && !isLiveAggregate(Loc))
         CurrTraits &= BitMemoryTrait::Private | SharedTrait;
       else {
+        std::unique_lock<std::mutex> Lock(mSharedAnalysisLock);
         auto *Expr = mSE->getSCEV(const_cast<Value *>(Loc.Ptr));
         bool IsInvariant =
           isLoopInvariant(Expr, L, *mTLI, *mSE, DefUse, *mAliasTree, AliasSTR);
+        Lock.unlock();
         if (IsInvariant && ExitingDefs.MustReach.contain(Loc))
           CurrTraits &= BitMemoryTrait::LastPrivate | SharedTrait;
         else if (IsInvariant && LatchDefs.MustReach.contain(Loc) &&
@@ -836,8 +998,10 @@ void PrivateRecognitionPass::resolveAccesses(Loop *L, const DFNode *LatchNode,
     auto I = NodeTraits.find(N);
     auto &AA = mAliasTree->getAliasAnalysis();
     auto *Call = dyn_cast<CallBase>(Unknown);
+    std::unique_lock<std::mutex> Lock(mSharedAnalysisLock);
     BitMemoryTrait TID = (Call && AA.onlyReadsMemory(Call)) ?
         BitMemoryTrait::Readonly : BitMemoryTrait::Dependency;
+    Lock.unlock();
     TID &= BitMemoryTrait::NoRedundant;
     I->get<UnknownList>().push_front(
       std::make_pair(Unknown, TID));
@@ -852,7 +1016,7 @@ void PrivateRecognitionPass::resolvePointers(
     auto BasePtr = getUnderlyingObject(const_cast<Value *>(Loc.Ptr), 0);
     // *p means that address of location should be loaded from p using 'load'.
     if (auto *LI = dyn_cast<LoadInst>(BasePtr)) {
-      auto *EM = mAliasTree->find(Loc);
+      auto *EM = findMemory(Loc);
       assert(EM && "Estimate memory location must not be null!");
       auto LocTraits = ExplicitAccesses.find(EM);
       assert(LocTraits != ExplicitAccesses.end() &&
@@ -864,7 +1028,7 @@ void PrivateRecognitionPass::resolvePointers(
           dropUnitFlag(*LocTraits->get<BitMemoryTrait>())
             == BitMemoryTrait::Shared)
         continue;
-      const EstimateMemory *Ptr = mAliasTree->find(MemoryLocation::get(LI));
+      const EstimateMemory *Ptr = findMemory(MemoryLocation::get(LI));
       assert(Ptr && "Estimate memory location must not be null!");
       // DefUse.getExplicitAccesses() contains largest memory location, so
       // if there are two instructions which access <P,8> and <P,?> then
@@ -902,7 +1066,7 @@ void PrivateRecognitionPass::resolveAddresses(DFLoop *L,
   assert(L && "Loop must not be null!");
   Loop *Lp = L->getLoop();
   for (Value *Ptr : DefUse.getAddressAccesses()) {
-    const EstimateMemory* Base = mAliasTree->find(MemoryLocation(Ptr, 0));
+    const EstimateMemory* Base = findMemory(MemoryLocation(Ptr, 0));
     assert(Base && "Estimate memory location must not be null!");
     auto Root = Base->getTopLevelParent();
     // Do not remember an address:
@@ -991,7 +1155,7 @@ void PrivateRecognitionPass::resolveAddresses(DFLoop *L,
   for (auto &[Ptr, Insts] : DefUse.getAddressTransitives()) {
     // TODO (kaniandr@gmail.com): extend address access analysis and set
     // 'nocapture'-like attribute for global variables.
-    const EstimateMemory *Base = mAliasTree->find(MemoryLocation(Ptr, 0));
+    const EstimateMemory *Base = findMemory(MemoryLocation(Ptr, 0));
     assert(Base && "Estimate memory location must not be null!");
     auto Pair = ExplicitAccesses.insert(std::make_pair(Base, nullptr));
     if (!Pair.second) {
@@ -1285,7 +1449,7 @@ void PrivateRecognitionPass::storeResults(
       "Dependence must be presented in the map!");
     auto Dep = EMToDep->get<DependenceImp>().get();
     Dep->get().for_each(DependenceImp::SummarizeFunctor<MemoryTraitSet>{
-      Dep, &*EMTraitItr, mSE});
+      Dep, &*EMTraitItr, mSE, &mSharedAnalysisLock});
     LLVM_DEBUG(
       dbgs() << "[PRIVATE]: summarize dependence for ";
       printLocationSource(dbgs(), MemoryLocation(
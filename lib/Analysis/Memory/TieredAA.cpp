@@ -0,0 +1,101 @@
+//===- TieredAA.cpp --- Tiered Alias Analysis -------------------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements an alias analysis which uses expensive Andersen's
+// analysis only for functions where cheaper analyses are not sufficient.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tsar/Analysis/Memory/TieredAA.h"
+#include <llvm/ADT/Statistic.h>
+#include <llvm/Analysis/TargetLibraryInfo.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instruction.h>
+#include <llvm/InitializePasses.h>
+
+using namespace llvm;
+
+#undef DEBUG_TYPE
+#define DEBUG_TYPE "tiered-aa"
+
+STATISTIC(NumUnresolvedQueries,
+  "Number of queries which are not resolved by cheap analyses");
+STATISTIC(NumEscalatedQueries,
+  "Number of queries forwarded to Andersen's analysis");
+STATISTIC(NumEscalatedNoAlias,
+  "Number of no-alias results obtained from Andersen's analysis");
+STATISTIC(NumEscalatedFunctions,
+  "Number of functions Andersen's analysis is used for");
+
+static const Function *getParentFunction(const Value *V) {
+  if (auto *I = dyn_cast<Instruction>(V))
+    return I->getFunction();
+  if (auto *A = dyn_cast<Argument>(V))
+    return A->getParent();
+  return nullptr;
+}
+
+AliasResult TieredAAResult::alias(const MemoryLocation &LocA,
+    const MemoryLocation &LocB, AAQueryInfo &AAQI) {
+  ++NumUnresolvedQueries;
+  auto *F = getParentFunction(LocA.Ptr);
+  if (!F)
+    F = getParentFunction(LocB.Ptr);
+  if (!F || !isEscalated(*F))
+    return AAResultBase::alias(LocA, LocB, AAQI);
+  ++NumEscalatedQueries;
+  auto Res = mAnders.alias(LocA, LocB, AAQI);
+  if (Res == AliasResult::NoAlias)
+    ++NumEscalatedNoAlias;
+  return Res;
+}
+
+void TieredAAResult::escalate(const Function &F) {
+  if (mEscalated.insert(&F).second)
+    ++NumEscalatedFunctions;
+}
+
+char TieredAAWrapperPass::ID = 0;
+INITIALIZE_PASS_BEGIN(TieredAAWrapperPass, "tiered-aa",
+  "Tiered Alias Analysis", false, true)
+INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
+INITIALIZE_PASS_END(TieredAAWrapperPass, "tiered-aa",
+  "Tiered Alias Analysis", false, true)
+
+ImmutablePass *llvm::createTieredAAWrapperPass() {
+  return new TieredAAWrapperPass;
+}
+
+void TieredAAWrapperPass::initializePass() {
+  auto GetTLI = [this](Function &F) -> const TargetLibraryInfo & {
+    return getAnalysis<TargetLibraryInfoWrapperPass>().getTLI(F);
+  };
+  mResult.reset(new TieredAAResult(GetTLI));
+}
+
+bool TieredAAWrapperPass::doFinalization(Module &M) {
+  mResult.reset();
+  return false;
+}
+
+void TieredAAWrapperPass::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<TargetLibraryInfoWrapperPass>();
+  AU.setPreservesAll();
+}
@@ -20,6 +20,7 @@ STATISTIC(TotalMemoryEdges, "Number of memory dependence edges created.");
 STATISTIC(TotalFineGrainedNodes, "Number of fine-grained nodes created.");
 STATISTIC(TotalPiBlockNodes, "Number of pi-block nodes created.");
 STATISTIC(TotalConfusedLLVMEdges, "Number of confused memory dependencies between two nodes.");
+STATISTIC(TotalMemoryPairs, "Number of pairs of memory accesses checked for dependence.");
 STATISTIC(TotalEdgeReversals, "Number of times the source and sink of dependence was reversed to expose cycles in the graph.");
 
 using PDG=ProgramDependencyGraph;
@@ -537,10 +538,11 @@ std::string PDGDotGraphTraits::getEdgeStyle(const tsar::PDGEdge *Edge) {
 //===--------------------------------------------------------------------===//
 PDGBuilder::PDGBuilder(PDG &G, const Function &F, DependenceInfo &DI,
     const AliasTree &AT, DIMemoryClientServerInfo &DIMInfo,
-    const TargetLibraryInfo &TLI, const LoopInfo &LI, bool SolveReachability,
-    bool Simplify, bool CreatePiBlocks)
+    const TargetLibraryInfo &TLI, const LoopInfo &LI,
+    const BasicBlockReachability *Reachability, bool Simplify,
+    bool CreatePiBlocks)
     : mGraph(G), mF(F), mDI(DI), mAT(AT), mDIMInfo(DIMInfo), mTLI(TLI),
-    mLI(LI), mSolvedReachability(SolveReachability), mSimplified(Simplify),
+    mLI(LI), mReachability(Reachability), mSimplified(Simplify),
     mCreatedPiBlocks(CreatePiBlocks), mClientDIATRel(DIMInfo.ClientDIAT),
     mBBList(F.size()) {
   if (mDIMInfo.isValid())
@@ -550,8 +552,6 @@ PDGBuilder::PDGBuilder(PDG &G, const Function &F, DependenceInfo &DI,
     for (auto It=po_begin(&F); It!=po_end(&F); ++It)
       mBBList[--BBIdx]=*It;
   }
-  if (SolveReachability)
-    solveReachability();
   LLVM_DEBUG(
     {
     DOTFuncInfo DOTCFGInfo(&F);
@@ -701,14 +701,87 @@ void PDGBuilder::createDefUseEdges() {
 }
 
 void PDGBuilder::createMemoryDependenceEdges() {
-  for (auto SrcNodeIt=mGraph.begin(); SrcNodeIt!=mGraph.end(); ++SrcNodeIt) {
-    if ((*SrcNodeIt)->getKind()==PDGNode::NodeKind::Entry)
+  // Bucket nodes which access memory by alias nodes. Accesses from different
+  // subtrees of the alias tree never alias, so there is no need to check
+  // corresponding pairs of nodes. If some location is not presented in the
+  // alias tree, the access is conservatively checked against all others.
+  SmallVector<SimplePDGNode *, 64> MemNodes;
+  SmallVector<SmallVector<const AliasNode *, 2>, 64> MemNodeAliases;
+  DenseMap<const AliasNode *, SmallVector<unsigned, 4>> Buckets;
+  SmallVector<unsigned, 8> UnknownNodes;
+  for (auto *N : mGraph) {
+    if (N->getKind()==PDGNode::NodeKind::Entry)
       continue;
-    SimplePDGNode &SrcInstrNode=*cast<SimplePDGNode>(*SrcNodeIt);
-    Instruction &SrcInstr=*SrcInstrNode.getFirstInstruction();
-    if (!SrcInstr.mayReadOrWriteMemory())
+    auto &InstrNode{*cast<SimplePDGNode>(N)};
+    auto &Instr{*InstrNode.getFirstInstruction()};
+    if (!Instr.mayReadOrWriteMemory())
       continue;
-    for (auto DstNodeIt=SrcNodeIt; DstNodeIt!=mGraph.end(); ++DstNodeIt) {
+    unsigned MemIdx{static_cast<unsigned>(MemNodes.size())};
+    MemNodes.push_back(&InstrNode);
+    auto &Aliases{MemNodeAliases.emplace_back()};
+    bool IsUnknown{false};
+    auto AddToBucket=[&Aliases, &Buckets, MemIdx](const AliasNode *AN) {
+      if (is_contained(Aliases, AN))
+        return;
+      Aliases.push_back(AN);
+      Buckets[AN].push_back(MemIdx);
+    };
+    for_each_memory(Instr, const_cast<TargetLibraryInfo &>(mTLI),
+        [this, &AddToBucket, &IsUnknown](Instruction &, MemoryLocation &&Loc,
+            unsigned, AccessInfo, AccessInfo) {
+          if (auto *EM{mAT.find(Loc)})
+            AddToBucket(EM->getAliasNode(mAT));
+          else
+            IsUnknown=true;
+        },
+        [this, &AddToBucket, &IsUnknown](Instruction &I, AccessInfo,
+            AccessInfo) {
+          if (auto *AN{mAT.findUnknown(I)})
+            AddToBucket(AN);
+          else
+            IsUnknown=true;
+        });
+    if (IsUnknown || Aliases.empty())
+      UnknownNodes.push_back(MemIdx);
+  }
+  // Accesses to memory from a specified alias node may alias accesses from
+  // its ancestors and descendants only.
+  DenseMap<const AliasNode *, BitVector> MayAliasCache;
+  auto getMayAlias=[this, &MemNodes, &Buckets, &MayAliasCache](
+      const AliasNode *AN) -> const BitVector & {
+    auto [Itr, IsNew]{MayAliasCache.try_emplace(AN)};
+    if (!IsNew)
+      return Itr->second;
+    BitVector MayAlias(MemNodes.size());
+    auto addBucket=[&Buckets, &MayAlias](const AliasNode *N) {
+      auto BucketItr{Buckets.find(N)};
+      if (BucketItr!=Buckets.end())
+        for (auto Idx : BucketItr->second)
+          MayAlias.set(Idx);
+    };
+    for (auto *N : depth_first(AN))
+      addBucket(N);
+    for (auto *N{AN->getParent(mAT)}; N; N=N->getParent(mAT))
+      addBucket(N);
+    Itr->second=std::move(MayAlias);
+    return Itr->second;
+  };
+  BitVector Unknown(MemNodes.size());
+  for (auto Idx : UnknownNodes)
+    Unknown.set(Idx);
+  for (unsigned SrcIdx=0, EIdx=MemNodes.size(); SrcIdx<EIdx; ++SrcIdx) {
+    BitVector Candidates(EIdx);
+    if (Unknown.test(SrcIdx)) {
+      Candidates.set();
+    } else {
+      Candidates=Unknown;
+      for (auto *AN : MemNodeAliases[SrcIdx])
+        Candidates|=getMayAlias(AN);
+    }
+    Candidates.reset(0, SrcIdx+1);
+    SimplePDGNode &SrcNode{*MemNodes[SrcIdx]};
+    Instruction &SrcInstr{*SrcNode.getFirstInstruction()};
+    for (auto DstIdx : Candidates.set_bits()) {
       SmallVector<PDGEdge*, 1> DefUseEdges;
       auto CreateDepEdge=[&DefUseEdges, this](PDGNode &Src, PDGNode &Tgt,
           const MemoryPDGEdge::MemDepHandle &Dep) {
@@ -725,16 +798,13 @@ void PDGBuilder::createMemoryDependenceEdges() {
               false))));
         ++TotalMemoryEdges;
       };
-      if (**SrcNodeIt==**DstNodeIt)
-        continue;
-      SimplePDGNode &DstInstrNode=*cast<SimplePDGNode>(*DstNodeIt);
-      Instruction &DstInstr=*DstInstrNode.getFirstInstruction();
-      if (!DstInstr.mayReadOrWriteMemory())
-        continue;
+      SimplePDGNode &DstNode{*MemNodes[DstIdx]};
+      Instruction &DstInstr{*DstNode.getFirstInstruction()};
       if (!(SrcInstr.getParent()==DstInstr.getParent() ||
           isReachable(*SrcInstr.getParent(), *DstInstr.getParent()) ||
           isReachable(*DstInstr.getParent(), *SrcInstr.getParent())))
         continue;
+      ++TotalMemoryPairs;
       std::unique_ptr<llvm::Dependence> Dep=mDI.depends(&SrcInstr, &DstInstr,
           true);
       MemoryPDGEdge::DIDepStorageT ForwardDIDep, BackwardDIDep;
@@ -749,9 +819,9 @@ void PDGBuilder::createMemoryDependenceEdges() {
           ForwardDIDep, BackwardDIDep)) {
         if (!ForwardDIDep.empty() || !BackwardDIDep.empty()) {
           if (!ForwardDIDep.empty())
-            CreateDepEdge(**SrcNodeIt, **DstNodeIt, ForwardDIDep);
+            CreateDepEdge(SrcNode, DstNode, ForwardDIDep);
           if (!BackwardDIDep.empty()) {
-            CreateDepEdge(**DstNodeIt, **SrcNodeIt, BackwardDIDep);
+            CreateDepEdge(DstNode, SrcNode, BackwardDIDep);
             ++TotalEdgeReversals;
           }
         }
@@ -760,8 +830,8 @@ void PDGBuilder::createMemoryDependenceEdges() {
               &DstInstr));
           CreateDepEdge(**DstNodeIt, **SrcNodeIt, new Dependence(&DstInstr,
               &SrcInstr));*/
-          CreateDepEdge(**SrcNodeIt, **DstNodeIt, Dep.release());
-          CreateDepEdge(**DstNodeIt, **SrcNodeIt, mDI.depends(&DstInstr,
+          CreateDepEdge(SrcNode, DstNode, Dep.release());
+          CreateDepEdge(DstNode, SrcNode, mDI.depends(&DstInstr,
               &SrcInstr, true).release());
           ++TotalConfusedLLVMEdges;
         }
@@ -774,25 +844,25 @@ void PDGBuilder::createMemoryDependenceEdges() {
             if (Dep->getDirection(Level)==Dependence::DVEntry::EQ)
               continue;
             if (Dep->getDirection(Level) == Dependence::DVEntry::GT) {
-              CreateDepEdge(**DstNodeIt, **SrcNodeIt, Dep.release());
+              CreateDepEdge(DstNode, SrcNode, Dep.release());
               ReversedEdge=true;
               ++TotalEdgeReversals;
               break;
             }
             if (Dep->getDirection(Level)==Dependence::DVEntry::LT)
               break;
-            CreateDepEdge(**SrcNodeIt, **DstNodeIt, Dep.release());
-            CreateDepEdge(**DstNodeIt, **SrcNodeIt, mDI.depends(&DstInstr,
+            CreateDepEdge(SrcNode, DstNode, Dep.release());
+            CreateDepEdge(DstNode, SrcNode, mDI.depends(&DstInstr,
                 &SrcInstr, true).release());
             ReversedEdge=true;
             ++TotalConfusedLLVMEdges;
             break;
           }
           if (!ReversedEdge)
-            CreateDepEdge(**SrcNodeIt, **DstNodeIt, Dep.release());
+            CreateDepEdge(SrcNode, DstNode, Dep.release());
         }
         else
-          CreateDepEdge(**SrcNodeIt, **DstNodeIt, Dep.release());
+          CreateDepEdge(SrcNode, DstNode, Dep.release());
       }
     }
   }
@@ -1325,6 +1395,7 @@ INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(EstimateMemoryPass)
 INITIALIZE_PASS_DEPENDENCY(DIEstimateMemoryPass)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(BasicBlockReachabilityPass)
 INITIALIZE_PASS_END(ProgramDependencyGraphPass, "pdg",
   "Program Dependency Graph", false, true)
 
@@ -1338,6 +1409,7 @@ void ProgramDependencyGraphPass::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequired<EstimateMemoryPass>();
   AU.addRequired<DIEstimateMemoryPass>();
   AU.addRequired<TargetLibraryInfoWrapperPass>();
+  AU.addRequired<BasicBlockReachabilityPass>();
   AU.setPreservesAll();
 }
 
@@ -1360,7 +1432,7 @@ bool ProgramDependencyGraphPass::runOnFunction(Function &F) {
     DIMInfo,
     TLIPass.getTLI(F),
     LIPass.getLoopInfo(),
-    true);
+    &getAnalysis<BasicBlockReachabilityPass>().getReachability());
   mPDGBuilder->populate();
   return false;
 }
@@ -29,6 +29,7 @@
 #include "tsar/Analysis/Memory/DIDependencyAnalysis.h"
 #include "tsar/Analysis/Memory/DIEstimateMemory.h"
 #include "tsar/Analysis/Memory/MemoryTraitUtils.h"
+#include "tsar/Analysis/Memory/TieredAA.h"
 #include "tsar/Support/GlobalOptions.h"
 #include "tsar/Support/IRUtils.h"
 #include "tsar/Support/Utils.h"
@@ -99,8 +100,9 @@ bool ParallelLoopPass::runOnFunction(Function &F) {
     LLVM_DEBUG(
         dbgs() << "[PARALLEL LOOP]: use dependence analysis from client\n");
   }
+  auto *TieredAA = getAnalysisIfAvailable<TieredAAWrapperPass>();
   for_each_loop(LI, [this, &F, &GO, &LoopAttr, &getLoopID, &getValue, DIAT,
-                     DIDepInfo](Loop *L) {
+                     DIDepInfo, TieredAA](Loop *L) {
     auto SLoc = L->getStartLoc();
     if (!getValidExitingBlock(*L) ||
         !LoopAttr.hasAttr(*L, AttrKind::AlwaysReturn) ||
@@ -180,6 +182,8 @@ bool ParallelLoopPass::runOnFunction(Function &F) {
         LLVM_DEBUG(dbgs() << "[PARALLEL LOOP]: memory aliasing "
                              "prevents parallelization: ";
                    SLoc.print(dbgs()); dbgs() << "\n");
+        if (TieredAA)
+          TieredAA->getResult().escalate(F);
         return;
       }
       auto &DIMTraitItr = *TS.begin();
@@ -28,8 +28,12 @@ using namespace llvm;
 
 void llvm::initializeAnalysisBase(PassRegistry &Registry) {
   initializeDFRegionInfoPassPass(Registry);
+  initializeBasicBlockReachabilityPassPass(Registry);
   initializeAnalysisConnectionImmutableWrapperPass(Registry);
   initializeProgramDependencyGraphPassPass(Registry);
   initializePDGPrinterPass(Registry);
   initializePDGViewerPass(Registry);
+  initializeFunctionChangeWrapperPass(Registry);
+  initializeFunctionChangeStoragePass(Registry);
+  initializeFunctionChangeTrackerPass(Registry);
 }
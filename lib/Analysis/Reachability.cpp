@@ -0,0 +1,50 @@
+//===- Reachability.cpp --- Basic Block Reachability ------------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a pass to compute reachability of basic blocks in a
+// function.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tsar/Analysis/Reachability.h"
+
+using namespace llvm;
+using namespace tsar;
+
+#undef DEBUG_TYPE
+#define DEBUG_TYPE "bb-reachability"
+
+char BasicBlockReachabilityPass::ID = 0;
+INITIALIZE_PASS(BasicBlockReachabilityPass, "bb-reachability",
+  "Basic Block Reachability", true, true)
+
+FunctionPass *llvm::createBasicBlockReachabilityPass() {
+  return new BasicBlockReachabilityPass;
+}
+
+void BasicBlockReachabilityPass::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.setPreservesAll();
+}
+
+bool BasicBlockReachabilityPass::runOnFunction(Function &F) {
+  releaseMemory();
+  mReachability.recalculate(&F);
+  return false;
+}
@@ -0,0 +1,420 @@
+//===- AnalysisBinary.cpp --- Binary Analysis Results -----------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a compact binary format to store external analysis
+// results.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tsar/Analysis/Reader/AnalysisBinary.h"
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/EndianStream.h>
+#include <llvm/Support/raw_ostream.h>
+#include <algorithm>
+#include <numeric>
+
+using namespace llvm;
+using namespace tsar;
+using namespace tsar::trait;
+using namespace tsar::trait::binary;
+using llvm::support::endian::read32le;
+
+namespace {
+/// Builder of a string table, each string is stored only once.
+class StringTable {
+public:
+  uint32_t get(StringRef Str) {
+    auto I{mIndex.try_emplace(Str, mStrings.size())};
+    if (I.second) {
+      mStrings.push_back(I.first->getKey());
+      mDataSize += Str.size();
+    }
+    return I.first->second;
+  }
+
+  uint32_t size() const { return mStrings.size(); }
+  uint32_t getDataSize() const { return mDataSize; }
+
+  void write(support::endian::Writer &W) const {
+    uint32_t Offset{0};
+    for (auto Str : mStrings) {
+      W.write<uint32_t>(Offset);
+      W.write<uint32_t>(Str.size());
+      Offset += Str.size();
+    }
+    for (auto Str : mStrings)
+      W.OS << Str;
+  }
+
+private:
+  StringMap<uint32_t> mIndex;
+  std::vector<StringRef> mStrings;
+  uint32_t mDataSize{0};
+};
+
+/// Trait of a variable in a loop.
+struct TraitRecord {
+  uint32_t Var;
+  TraitKind Kind;
+  uint8_t Mask;
+  int32_t A;
+  int32_t B;
+  int32_t C;
+};
+
+/// Collect all traits of a specified loop.
+void collectTraits(const Loop &L, std::vector<TraitRecord> &Traits) {
+  auto addSet = [&Traits](const std::set<IdTy> &Vars, TraitKind Kind) {
+    for (auto Var : Vars)
+      Traits.push_back({static_cast<uint32_t>(Var), Kind, 0, 0, 0, 0});
+  };
+  auto addDistance = [&Traits](const std::map<IdTy, Distance> &Vars,
+                               TraitKind Kind) {
+    for (auto &[Var, D] : Vars) {
+      TraitRecord T{static_cast<uint32_t>(Var), Kind, 0, 0, 0, 0};
+      if (auto Min{D[Distance::Min]}) {
+        T.Mask |= HasA;
+        T.A = *Min;
+      }
+      if (auto Max{D[Distance::Max]}) {
+        T.Mask |= HasB;
+        T.B = *Max;
+      }
+      Traits.push_back(T);
+    }
+  };
+  addSet(L[Loop::Private], TraitKind::Private);
+  for (auto &[Var, Kind] : L[Loop::Reduction])
+    Traits.push_back({static_cast<uint32_t>(Var), TraitKind::Reduction, HasA,
+                      static_cast<int32_t>(Kind), 0, 0});
+  for (auto &[Var, R] : L[Loop::Induction]) {
+    TraitRecord T{static_cast<uint32_t>(Var), TraitKind::Induction, 0, 0, 0, 0};
+    if (auto Start{R[Range::Start]}) {
+      T.Mask |= HasA;
+      T.A = *Start;
+    }
+    if (auto End{R[Range::End]}) {
+      T.Mask |= HasB;
+      T.B = *End;
+    }
+    if (auto Step{R[Range::Step]}) {
+      T.Mask |= HasC;
+      T.C = *Step;
+    }
+    Traits.push_back(T);
+  }
+  addDistance(L[Loop::Flow], TraitKind::Flow);
+  addDistance(L[Loop::Anti], TraitKind::Anti);
+  addSet(L[Loop::Output], TraitKind::Output);
+  addSet(L[Loop::WriteOccurred], TraitKind::WriteOccurred);
+  addSet(L[Loop::ReadOccurred], TraitKind::ReadOccurred);
+  addSet(L[Loop::UseAfterLoop], TraitKind::UseAfterLoop);
+  addSet(L[Loop::DefBeforeLoop], TraitKind::DefBeforeLoop);
+}
+
+/// Decode location of a record, `HasName` is true if a record contains name.
+void readLocation(const char *Rec, StringRef File, bool HasName,
+                  StringRef Name, InfoStream::Record &R) {
+  R.File = File.str();
+  R.Line = read32le(Rec + sizeof(uint32_t));
+  R.Column = read32le(Rec + 2 * sizeof(uint32_t));
+  if (HasName)
+    R.Name = Name.str();
+  else
+    R.Name.clear();
+}
+}
+
+bool tsar::trait::isBinaryInfo(StringRef Buffer) {
+  return Buffer.startswith(StringRef(Magic, sizeof(Magic)));
+}
+
+void tsar::trait::writeBinaryInfo(const Info &Info, raw_ostream &OS) {
+  auto &Functions{Info[Info::Functions]};
+  auto &Vars{Info[Info::Vars]};
+  auto &Loops{Info[Info::Loops]};
+  StringTable Strings;
+  for (auto &F : Functions) {
+    Strings.get(F[Function::File]);
+    Strings.get(F[Function::Name]);
+  }
+  for (auto &V : Vars) {
+    Strings.get(V[Var::File]);
+    Strings.get(V[Var::Name]);
+  }
+  // Group loops by files to build an index by source location.
+  std::vector<uint32_t> LoopFiles;
+  LoopFiles.reserve(Loops.size());
+  for (auto &L : Loops)
+    LoopFiles.push_back(Strings.get(L[Loop::File]));
+  std::vector<std::size_t> Order(Loops.size());
+  std::iota(Order.begin(), Order.end(), 0);
+  std::stable_sort(Order.begin(), Order.end(),
+    [&Loops, &LoopFiles](std::size_t LHS, std::size_t RHS) {
+      return std::make_tuple(LoopFiles[LHS], Loops[LHS][Loop::Line],
+                             Loops[LHS][Loop::Column]) <
+             std::make_tuple(LoopFiles[RHS], Loops[RHS][Loop::Line],
+                             Loops[RHS][Loop::Column]);
+    });
+  std::vector<std::pair<uint32_t, uint32_t>> Files;
+  std::vector<TraitRecord> Traits;
+  std::vector<std::pair<uint32_t, uint32_t>> LoopTraits;
+  LoopTraits.reserve(Loops.size());
+  for (std::size_t I = 0, EI = Order.size(); I < EI; ++I) {
+    if (Files.empty() || LoopFiles[Order[Files.back().first]] !=
+                             LoopFiles[Order[I]])
+      Files.emplace_back(I, 0);
+    ++Files.back().second;
+    auto FirstTrait{Traits.size()};
+    collectTraits(Loops[Order[I]], Traits);
+    LoopTraits.emplace_back(FirstTrait, Traits.size() - FirstTrait);
+  }
+  support::endian::Writer W(OS, support::little);
+  OS.write(Magic, sizeof(Magic));
+  W.write<uint32_t>(Version);
+  W.write<uint32_t>(Strings.size());
+  W.write<uint32_t>(Strings.getDataSize());
+  W.write<uint32_t>(Functions.size());
+  W.write<uint32_t>(Vars.size());
+  W.write<uint32_t>(Files.size());
+  W.write<uint32_t>(Loops.size());
+  W.write<uint32_t>(Traits.size());
+  Strings.write(W);
+  for (auto &F : Functions) {
+    W.write<uint32_t>(Strings.get(F[Function::File]));
+    W.write<uint32_t>(F[Function::Line]);
+    W.write<uint32_t>(F[Function::Column]);
+    W.write<uint32_t>(Strings.get(F[Function::Name]));
+    W.write<uint32_t>(F[Function::Pure] ? FunctionFlags::Pure : 0);
+  }
+  for (auto &V : Vars) {
+    W.write<uint32_t>(Strings.get(V[Var::File]));
+    W.write<uint32_t>(V[Var::Line]);
+    W.write<uint32_t>(V[Var::Column]);
+    W.write<uint32_t>(Strings.get(V[Var::Name]));
+  }
+  for (auto &[FirstLoop, NumLoops] : Files) {
+    W.write<uint32_t>(LoopFiles[Order[FirstLoop]]);
+    W.write<uint32_t>(FirstLoop);
+    W.write<uint32_t>(NumLoops);
+  }
+  for (std::size_t I = 0, EI = Order.size(); I < EI; ++I) {
+    auto &L{Loops[Order[I]]};
+    W.write<uint32_t>(LoopFiles[Order[I]]);
+    W.write<uint32_t>(L[Loop::Line]);
+    W.write<uint32_t>(L[Loop::Column]);
+    W.write<uint32_t>(LoopTraits[I].first);
+    W.write<uint32_t>(LoopTraits[I].second);
+  }
+  for (auto &T : Traits) {
+    W.write<uint32_t>(T.Var);
+    W.write<uint8_t>(static_cast<uint8_t>(T.Kind));
+    W.write<uint8_t>(T.Mask);
+    W.write<uint16_t>(0);
+    W.write<int32_t>(T.A);
+    W.write<int32_t>(T.B);
+    W.write<int32_t>(T.C);
+  }
+}
+
+bool BinaryInfoStream::init() {
+  auto error = [this](const Twine &Msg) {
+    mError = Msg.str();
+    return false;
+  };
+  auto Buffer{mBuffer->getBuffer()};
+  if (Buffer.size() < HeaderSize || !isBinaryInfo(Buffer))
+    return error("unknown format of a file");
+  auto *Ptr{Buffer.data() + sizeof(Magic)};
+  auto next = [&Ptr]() {
+    auto V{read32le(Ptr)};
+    Ptr += sizeof(uint32_t);
+    return V;
+  };
+  if (auto V{next()}; V != Version)
+    return error("unsupported version " + Twine(V) + " of binary format");
+  mNumStrings = next();
+  mStringDataSize = next();
+  mNumFunctions = next();
+  mNumVars = next();
+  mNumFiles = next();
+  mNumLoops = next();
+  mNumTraits = next();
+  uint64_t Size{HeaderSize + uint64_t(mNumStrings) * StringEntrySize +
+                mStringDataSize + uint64_t(mNumFunctions) * FunctionSize +
+                uint64_t(mNumVars) * VarSize + uint64_t(mNumFiles) * FileSize +
+                uint64_t(mNumLoops) * LoopSize +
+                uint64_t(mNumTraits) * TraitSize};
+  if (Size != Buffer.size())
+    return error("unexpected size of a file");
+  mStrings = Ptr;
+  mStringData = mStrings + mNumStrings * StringEntrySize;
+  mFunctions = mStringData + mStringDataSize;
+  mVars = mFunctions + mNumFunctions * FunctionSize;
+  mFiles = mVars + mNumVars * VarSize;
+  mLoops = mFiles + mNumFiles * FileSize;
+  mTraits = mLoops + mNumLoops * LoopSize;
+  for (uint32_t I = 0; I < mNumStrings; ++I) {
+    auto *Entry{mStrings + I * StringEntrySize};
+    if (uint64_t(read32le(Entry)) + read32le(Entry + sizeof(uint32_t)) >
+        mStringDataSize)
+      return error("string " + Twine(I) + " is out of the string table");
+  }
+  return true;
+}
+
+StringRef BinaryInfoStream::getString(uint32_t Idx) const {
+  if (Idx >= mNumStrings)
+    return StringRef();
+  auto *Entry{mStrings + Idx * StringEntrySize};
+  return StringRef(mStringData + read32le(Entry),
+                   read32le(Entry + sizeof(uint32_t)));
+}
+
+bool BinaryInfoStream::isIn(StringRef Raw, const char *Section, uint32_t Num,
+                            std::size_t RecordSize) const {
+  return Section && Raw.size() == RecordSize && Raw.data() >= Section &&
+         Raw.data() < Section + Num * RecordSize &&
+         (Raw.data() - Section) % RecordSize == 0;
+}
+
+bool BinaryInfoStream::scan(VisitorT Visitor, FilterT Filter) {
+  mError.clear();
+  if (!init())
+    return false;
+  Record R;
+  for (uint32_t I = 0; I < mNumFunctions; ++I) {
+    auto *Rec{mFunctions + I * FunctionSize};
+    auto File{getString(read32le(Rec))};
+    if (!Filter(RecordKind::Function, File))
+      continue;
+    R.Raw = StringRef(Rec, FunctionSize);
+    readLocation(Rec, File, true, getString(read32le(Rec + 12)), R);
+    Visitor(RecordKind::Function, R);
+  }
+  for (uint32_t I = 0; I < mNumVars; ++I) {
+    auto *Rec{mVars + I * VarSize};
+    R.Raw = StringRef(Rec, VarSize);
+    readLocation(Rec, getString(read32le(Rec)), true,
+                 getString(read32le(Rec + 12)), R);
+    Visitor(RecordKind::Var, R);
+  }
+  for (uint32_t I = 0; I < mNumFiles; ++I) {
+    auto *Entry{mFiles + I * FileSize};
+    auto File{getString(read32le(Entry))};
+    auto FirstLoop{read32le(Entry + 4)}, NumLoops{read32le(Entry + 8)};
+    if (uint64_t(FirstLoop) + NumLoops > mNumLoops) {
+      mError = "loops of file " + std::to_string(I) + " are out of range";
+      return false;
+    }
+    // Skip all loops from a file at once.
+    if (!Filter(RecordKind::Loop, File))
+      continue;
+    for (uint32_t J = FirstLoop, EJ = FirstLoop + NumLoops; J < EJ; ++J) {
+      auto *Rec{mLoops + J * LoopSize};
+      R.Raw = StringRef(Rec, LoopSize);
+      readLocation(Rec, getString(read32le(Rec)), false, "", R);
+      Visitor(RecordKind::Loop, R);
+    }
+  }
+  return true;
+}
+
+bool BinaryInfoStream::readRecord(StringRef Raw, Record &R) const {
+  bool IsLoop{isIn(Raw, mLoops, mNumLoops, LoopSize)};
+  if (!IsLoop && !isIn(Raw, mFunctions, mNumFunctions, FunctionSize) &&
+      !isIn(Raw, mVars, mNumVars, VarSize))
+    return false;
+  R.Raw = Raw;
+  readLocation(Raw.data(), getString(read32le(Raw.data())), !IsLoop,
+               IsLoop ? "" : getString(read32le(Raw.data() + 12)), R);
+  return true;
+}
+
+bool BinaryInfoStream::parse(StringRef Raw, Function &F,
+                             ErrorList &Errors) const {
+  if (!isIn(Raw, mFunctions, mNumFunctions, FunctionSize)) {
+    Errors.emplace_back("invalid function record");
+    return false;
+  }
+  auto *Rec{Raw.data()};
+  F[Function::File] = getString(read32le(Rec)).str();
+  F[Function::Line] = read32le(Rec + 4);
+  F[Function::Column] = read32le(Rec + 8);
+  F[Function::Name] = getString(read32le(Rec + 12)).str();
+  F[Function::Pure] = read32le(Rec + 16) & FunctionFlags::Pure;
+  return true;
+}
+
+bool BinaryInfoStream::parse(StringRef Raw, Loop &L, ErrorList &Errors) const {
+  if (!isIn(Raw, mLoops, mNumLoops, LoopSize)) {
+    Errors.emplace_back("invalid loop record");
+    return false;
+  }
+  auto *Rec{Raw.data()};
+  L[Loop::File] = getString(read32le(Rec)).str();
+  L[Loop::Line] = read32le(Rec + 4);
+  L[Loop::Column] = read32le(Rec + 8);
+  auto FirstTrait{read32le(Rec + 12)}, NumTraits{read32le(Rec + 16)};
+  if (uint64_t(FirstTrait) + NumTraits > mNumTraits) {
+    Errors.emplace_back("traits of a loop are out of range");
+    return false;
+  }
+  for (uint32_t I = FirstTrait, EI = FirstTrait + NumTraits; I < EI; ++I) {
+    auto *T{mTraits + I * TraitSize};
+    IdTy Var{read32le(T)};
+    auto Kind{static_cast<uint8_t>(T[4])};
+    auto Mask{static_cast<uint8_t>(T[5])};
+    auto get = [T, Mask](uint8_t Bit, unsigned Offset) -> DistanceTy {
+      if (!(Mask & Bit))
+        return std::nullopt;
+      return static_cast<int32_t>(read32le(T + Offset));
+    };
+    switch (static_cast<TraitKind>(Kind)) {
+    case TraitKind::Private: L[Loop::Private].insert(Var); break;
+    case TraitKind::Reduction: {
+      auto RK{get(HasA, 8)};
+      L[Loop::Reduction].emplace(Var,
+        RK && *RK >= Reduction::RK_First && *RK < Reduction::RK_NumberOf
+          ? static_cast<Reduction::Kind>(*RK) : Reduction::RK_NoReduction);
+      break;
+    }
+    case TraitKind::Induction:
+      L[Loop::Induction].emplace(Var,
+        Range(get(HasA, 8), get(HasB, 12), get(HasC, 16)));
+      break;
+    case TraitKind::Flow:
+      L[Loop::Flow].emplace(Var, Distance(get(HasA, 8), get(HasB, 12)));
+      break;
+    case TraitKind::Anti:
+      L[Loop::Anti].emplace(Var, Distance(get(HasA, 8), get(HasB, 12)));
+      break;
+    case TraitKind::Output: L[Loop::Output].insert(Var); break;
+    case TraitKind::WriteOccurred: L[Loop::WriteOccurred].insert(Var); break;
+    case TraitKind::ReadOccurred: L[Loop::ReadOccurred].insert(Var); break;
+    case TraitKind::UseAfterLoop: L[Loop::UseAfterLoop].insert(Var); break;
+    case TraitKind::DefBeforeLoop: L[Loop::DefBeforeLoop].insert(Var); break;
+    default:
+      Errors.emplace_back("unknown kind of trait " + std::to_string(Kind));
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,296 @@
+//===- AnalysisJSONStream.cpp --- Analysis Results Stream -------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a lightweight reader which scans external analysis
+// results in JSON format without building of a whole DOM in memory.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tsar/Analysis/Reader/AnalysisJSONStream.h"
+#include "tsar/Analysis/Reader/AnalysisBinary.h"
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/ConvertUTF.h>
+#include <llvm/Support/raw_ostream.h>
+
+using namespace llvm;
+using namespace tsar;
+using namespace tsar::trait;
+
+namespace {
+/// Minimal JSON lexer over a memory buffer.
+///
+/// It does not allocate memory for skipped values and it does not check
+/// values which are skipped, they are checked when a record is parsed.
+class Lexer {
+public:
+  explicit Lexer(StringRef Buffer)
+      : mBegin(Buffer.begin()), mPtr(Buffer.begin()), mEnd(Buffer.end()) {}
+
+  const char *getPosition() const noexcept { return mPtr; }
+  std::size_t getOffset() const noexcept { return mPtr - mBegin; }
+
+  bool atEnd() {
+    skipSpaces();
+    return mPtr == mEnd;
+  }
+
+  /// Consume a specified punctuator if it is the next token.
+  bool consume(char C) {
+    skipSpaces();
+    if (mPtr == mEnd || *mPtr != C)
+      return false;
+    ++mPtr;
+    return true;
+  }
+
+  /// Read a key of an object member, escape sequences are not decoded.
+  bool readKey(StringRef &Key) {
+    skipSpaces();
+    if (mPtr == mEnd || *mPtr != '"')
+      return false;
+    auto *Start{++mPtr};
+    for (; mPtr != mEnd && *mPtr != '"'; ++mPtr)
+      if (*mPtr == '\\' && ++mPtr == mEnd)
+        return false;
+    if (mPtr == mEnd)
+      return false;
+    Key = StringRef(Start, mPtr - Start);
+    ++mPtr;
+    return consume(':');
+  }
+
+  /// Read a string, if `Str` is not null a decoded value is stored in it.
+  bool readString(std::string *Str) {
+    skipSpaces();
+    if (mPtr == mEnd || *mPtr != '"')
+      return false;
+    ++mPtr;
+    if (Str)
+      Str->clear();
+    while (mPtr != mEnd && *mPtr != '"') {
+      if (*mPtr != '\\') {
+        if (Str)
+          Str->push_back(*mPtr);
+        ++mPtr;
+        continue;
+      }
+      if (++mPtr == mEnd)
+        return false;
+      char C{*mPtr++};
+      if (!Str)
+        continue;
+      switch (C) {
+      case 'b': Str->push_back('\b'); break;
+      case 'f': Str->push_back('\f'); break;
+      case 'n': Str->push_back('\n'); break;
+      case 'r': Str->push_back('\r'); break;
+      case 't': Str->push_back('\t'); break;
+      case 'u': {
+        unsigned CodePoint;
+        if (mEnd - mPtr < 4 || StringRef(mPtr, 4).getAsInteger(16, CodePoint))
+          return false;
+        mPtr += 4;
+        char Buf[UNI_MAX_UTF8_BYTES_PER_CODE_POINT];
+        char *ResultPtr{Buf};
+        if (!ConvertCodePointToUTF8(CodePoint, ResultPtr))
+          return false;
+        Str->append(Buf, ResultPtr);
+        break;
+      }
+      default: Str->push_back(C); break;
+      }
+    }
+    if (mPtr == mEnd)
+      return false;
+    ++mPtr;
+    return true;
+  }
+
+  /// Read an unsigned integer value.
+  bool readUnsigned(uint64_t &Value) {
+    skipSpaces();
+    auto *Start{mPtr};
+    while (mPtr != mEnd && isDigit(*mPtr))
+      ++mPtr;
+    return !StringRef(Start, mPtr - Start).getAsInteger(10, Value);
+  }
+
+  /// Skip the next value without its materialization.
+  bool skipValue() {
+    skipSpaces();
+    if (mPtr == mEnd)
+      return false;
+    if (*mPtr == '"')
+      return readString(nullptr);
+    if (*mPtr != '{' && *mPtr != '[') {
+      auto *Start{mPtr};
+      while (mPtr != mEnd && (isAlnum(*mPtr) || *mPtr == '-' || *mPtr == '+' ||
+                              *mPtr == '.'))
+        ++mPtr;
+      return Start != mPtr;
+    }
+    unsigned Depth{0};
+    do {
+      if (*mPtr == '"') {
+        if (!readString(nullptr))
+          return false;
+        continue;
+      }
+      if (*mPtr == '{' || *mPtr == '[')
+        ++Depth;
+      else if (*mPtr == '}' || *mPtr == ']')
+        --Depth;
+      ++mPtr;
+    } while (Depth > 0 && mPtr != mEnd);
+    return Depth == 0;
+  }
+
+private:
+  void skipSpaces() {
+    while (mPtr != mEnd && isSpace(*mPtr))
+      ++mPtr;
+  }
+
+  const char *mBegin;
+  const char *mPtr;
+  const char *mEnd;
+};
+
+/// Decode location of a record, the lexer points to the beginning of a record.
+bool readRecord(Lexer &Lex, InfoStream::Record &R) {
+  if (!Lex.consume('{'))
+    return false;
+  if (Lex.consume('}'))
+    return true;
+  do {
+    StringRef Key;
+    if (!Lex.readKey(Key))
+      return false;
+    uint64_t Value;
+    if (Key == "File") {
+      if (!Lex.readString(&R.File))
+        return false;
+    } else if (Key == "Name") {
+      if (!Lex.readString(&R.Name))
+        return false;
+    } else if (Key == "Line") {
+      if (!Lex.readUnsigned(Value))
+        return false;
+      R.Line = Value;
+    } else if (Key == "Column") {
+      if (!Lex.readUnsigned(Value))
+        return false;
+      R.Column = Value;
+    } else if (!Lex.skipValue()) {
+      return false;
+    }
+  } while (Lex.consume(','));
+  return Lex.consume('}');
+}
+}
+
+ErrorOr<std::unique_ptr<InfoStream>> InfoStream::open(const Twine &Path) {
+  // Large files are mapped into memory, so do not require null terminator
+  // which may force the whole file to be read.
+  auto BufferOrErr{MemoryBuffer::getFile(Path, false, false)};
+  if (!BufferOrErr)
+    return BufferOrErr.getError();
+  if (isBinaryInfo((**BufferOrErr).getBuffer()))
+    return std::make_unique<BinaryInfoStream>(std::move(*BufferOrErr));
+  return std::make_unique<JSONInfoStream>(std::move(*BufferOrErr));
+}
+
+bool JSONInfoStream::readRecord(StringRef Raw, Record &R) const {
+  Lexer Lex(Raw);
+  R.Raw = Raw;
+  return ::readRecord(Lex, R) && Lex.atEnd();
+}
+
+template<class T> static bool parseRecord(StringRef Raw, T &Obj,
+    InfoStream::ErrorList &Errors) {
+  json::Parser<> Parser(Raw.str());
+  if (Parser.parse(Obj))
+    return true;
+  for (auto &D : Parser.errors())
+    Errors.emplace_back(D);
+  return false;
+}
+
+bool JSONInfoStream::parse(StringRef Raw, Function &F,
+                           ErrorList &Errors) const {
+  return parseRecord(Raw, F, Errors);
+}
+
+bool JSONInfoStream::parse(StringRef Raw, Loop &L, ErrorList &Errors) const {
+  return parseRecord(Raw, L, Errors);
+}
+
+bool JSONInfoStream::scan(VisitorT Visitor, FilterT Filter) {
+  mError.clear();
+  Lexer Lex(mBuffer->getBuffer());
+  auto error = [this, &Lex](const Twine &Msg) {
+    raw_string_ostream(mError)
+        << Msg << " at offset " << Lex.getOffset();
+    return false;
+  };
+  if (!Lex.consume('{'))
+    return error("expected '{'");
+  if (!Lex.consume('}')) {
+    do {
+      StringRef Key;
+      if (!Lex.readKey(Key))
+        return error("expected key of an object member");
+      RecordKind Kind;
+      if (Key == "Functions") {
+        Kind = RecordKind::Function;
+      } else if (Key == "Vars") {
+        Kind = RecordKind::Var;
+      } else if (Key == "Loops") {
+        Kind = RecordKind::Loop;
+      } else {
+        if (!Lex.skipValue())
+          return error("malformed value");
+        continue;
+      }
+      if (!Lex.consume('['))
+        return error("expected '['");
+      if (Lex.consume(']'))
+        continue;
+      Record R;
+      do {
+        Lex.atEnd();
+        auto *Start{Lex.getPosition()};
+        R = Record{};
+        if (!::readRecord(Lex, R))
+          return error(Twine("malformed record in '") + Key + "'");
+        R.Raw = StringRef(Start, Lex.getPosition() - Start);
+        if (Kind == RecordKind::Var || Filter(Kind, R.File))
+          Visitor(Kind, R);
+      } while (Lex.consume(','));
+      if (!Lex.consume(']'))
+        return error("expected ']'");
+    } while (Lex.consume(','));
+    if (!Lex.consume('}'))
+      return error("expected '}'");
+  }
+  if (!Lex.atEnd())
+    return error("unexpected data after the top-level object");
+  return true;
+}
@@ -0,0 +1,256 @@
+//===- AnalysisMerge.cpp --- Analysis Results Merger ------------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements functions to merge external analysis results which are
+// obtained in different runs of a program.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tsar/Analysis/Reader/AnalysisMerge.h"
+#include <llvm/Support/ThreadPool.h>
+#include <map>
+#include <tuple>
+
+using namespace llvm;
+using namespace tsar;
+using namespace tsar::trait;
+
+namespace {
+using VarKey = std::tuple<std::string, LineTy, ColumnTy, std::string>;
+using LoopKey = std::tuple<std::string, LineTy, ColumnTy>;
+using FunctionKey = std::tuple<std::string, LineTy, std::string>;
+
+/// Merge two values, a value is unknown if it is unknown or different
+/// in one of runs.
+DistanceTy mergeExact(DistanceTy LHS, DistanceTy RHS) {
+  return LHS == RHS ? LHS : std::nullopt;
+}
+
+/// Merge bounds of two dependence distances, the result covers both ranges.
+Distance mergeDistance(const Distance &LHS, const Distance &RHS) {
+  auto Min{LHS[Distance::Min] && RHS[Distance::Min]
+               ? DistanceTy(std::min(*LHS[Distance::Min], *RHS[Distance::Min]))
+               : std::nullopt};
+  auto Max{LHS[Distance::Max] && RHS[Distance::Max]
+               ? DistanceTy(std::max(*LHS[Distance::Max], *RHS[Distance::Max]))
+               : std::nullopt};
+  return Distance(Min, Max);
+}
+
+/// Return variables which are mentioned in a specified loop.
+std::set<IdTy> collectAccessed(const Loop &L) {
+  std::set<IdTy> Res;
+  auto addSet = [&Res](const std::set<IdTy> &S) {
+    Res.insert(S.begin(), S.end());
+  };
+  auto addMap = [&Res](const auto &M) {
+    for (auto &Pair : M)
+      Res.insert(Pair.first);
+  };
+  addSet(L[Loop::Private]);
+  addMap(L[Loop::Reduction]);
+  addMap(L[Loop::Induction]);
+  addMap(L[Loop::Flow]);
+  addMap(L[Loop::Anti]);
+  addSet(L[Loop::Output]);
+  addSet(L[Loop::WriteOccurred]);
+  addSet(L[Loop::ReadOccurred]);
+  addSet(L[Loop::UseAfterLoop]);
+  addSet(L[Loop::DefBeforeLoop]);
+  return Res;
+}
+
+/// Merge traits of a loop `From` into traits of a loop `To`, variables must be
+/// already numbered in the same way.
+void mergeLoop(Loop &To, const Loop &From) {
+  auto AccessedTo{collectAccessed(To)};
+  auto AccessedFrom{collectAccessed(From)};
+  // Return true if a property holds in both runs which access a variable.
+  auto holds = [&AccessedTo, &AccessedFrom](IdTy Var, bool InTo,
+                                            bool InFrom) {
+    return (InTo || !AccessedTo.count(Var)) &&
+           (InFrom || !AccessedFrom.count(Var));
+  };
+  std::set<IdTy> Private;
+  for (auto Var : To[Loop::Private])
+    if (holds(Var, true, From[Loop::Private].count(Var)))
+      Private.insert(Var);
+  for (auto Var : From[Loop::Private])
+    if (holds(Var, To[Loop::Private].count(Var), true))
+      Private.insert(Var);
+  To[Loop::Private] = std::move(Private);
+  // Reductions of different kinds result in a dependence with unknown
+  // distance.
+  auto &ToReduction{To[Loop::Reduction]};
+  for (auto I = ToReduction.begin(), EI = ToReduction.end(); I != EI;) {
+    auto FromItr{From[Loop::Reduction].find(I->first)};
+    bool InFrom{FromItr != From[Loop::Reduction].end()};
+    if (InFrom && FromItr->second != I->second) {
+      To[Loop::Flow].try_emplace(I->first);
+      To[Loop::Anti].try_emplace(I->first);
+      I = ToReduction.erase(I);
+    } else if (!holds(I->first, true, InFrom)) {
+      I = ToReduction.erase(I);
+    } else {
+      ++I;
+    }
+  }
+  for (auto &[Var, Kind] : From[Loop::Reduction])
+    if (holds(Var, false, true))
+      ToReduction.emplace(Var, Kind);
+  auto &ToInduction{To[Loop::Induction]};
+  for (auto I = ToInduction.begin(), EI = ToInduction.end(); I != EI;) {
+    auto FromItr{From[Loop::Induction].find(I->first)};
+    bool InFrom{FromItr != From[Loop::Induction].end()};
+    if (!holds(I->first, true, InFrom)) {
+      I = ToInduction.erase(I);
+      continue;
+    }
+    if (InFrom)
+      I->second = Range(
+          mergeExact(I->second[Range::Start], FromItr->second[Range::Start]),
+          mergeExact(I->second[Range::End], FromItr->second[Range::End]),
+          mergeExact(I->second[Range::Step], FromItr->second[Range::Step]));
+    ++I;
+  }
+  for (auto &[Var, R] : From[Loop::Induction])
+    if (holds(Var, false, true))
+      ToInduction.emplace(Var, R);
+  auto mergeDependence = [](std::map<IdTy, Distance> &To,
+                            const std::map<IdTy, Distance> &From) {
+    for (auto &[Var, D] : From) {
+      auto Itr{To.try_emplace(Var, D)};
+      if (!Itr.second)
+        Itr.first->second = mergeDistance(Itr.first->second, D);
+    }
+  };
+  mergeDependence(To[Loop::Flow], From[Loop::Flow]);
+  mergeDependence(To[Loop::Anti], From[Loop::Anti]);
+  auto mergeSet = [](std::set<IdTy> &To, const std::set<IdTy> &From) {
+    To.insert(From.begin(), From.end());
+  };
+  mergeSet(To[Loop::Output], From[Loop::Output]);
+  mergeSet(To[Loop::WriteOccurred], From[Loop::WriteOccurred]);
+  mergeSet(To[Loop::ReadOccurred], From[Loop::ReadOccurred]);
+  mergeSet(To[Loop::UseAfterLoop], From[Loop::UseAfterLoop]);
+  mergeSet(To[Loop::DefBeforeLoop], From[Loop::DefBeforeLoop]);
+}
+
+/// Renumber variables in a specified loop.
+Loop remapLoop(const Loop &L, const std::vector<IdTy> &VarMap) {
+  Loop Res;
+  Res[Loop::File] = L[Loop::File];
+  Res[Loop::Line] = L[Loop::Line];
+  Res[Loop::Column] = L[Loop::Column];
+  auto remapSet = [&VarMap](const std::set<IdTy> &From, std::set<IdTy> &To) {
+    for (auto Var : From)
+      if (Var < VarMap.size())
+        To.insert(VarMap[Var]);
+  };
+  auto remapMap = [&VarMap](const auto &From, auto &To) {
+    for (auto &[Var, Value] : From)
+      if (Var < VarMap.size())
+        To.emplace(VarMap[Var], Value);
+  };
+  remapSet(L[Loop::Private], Res[Loop::Private]);
+  remapMap(L[Loop::Reduction], Res[Loop::Reduction]);
+  remapMap(L[Loop::Induction], Res[Loop::Induction]);
+  remapMap(L[Loop::Flow], Res[Loop::Flow]);
+  remapMap(L[Loop::Anti], Res[Loop::Anti]);
+  remapSet(L[Loop::Output], Res[Loop::Output]);
+  remapSet(L[Loop::WriteOccurred], Res[Loop::WriteOccurred]);
+  remapSet(L[Loop::ReadOccurred], Res[Loop::ReadOccurred]);
+  remapSet(L[Loop::UseAfterLoop], Res[Loop::UseAfterLoop]);
+  remapSet(L[Loop::DefBeforeLoop], Res[Loop::DefBeforeLoop]);
+  return Res;
+}
+}
+
+void tsar::trait::mergeInfo(Info &To, const Info &From) {
+  auto &ToVars{To[Info::Vars]};
+  std::map<VarKey, IdTy> Vars;
+  for (IdTy I = 0, EI = ToVars.size(); I < EI; ++I)
+    Vars.try_emplace(VarKey{ToVars[I][Var::File], ToVars[I][Var::Line],
+                            ToVars[I][Var::Column], ToVars[I][Var::Name]},
+                     I);
+  std::vector<IdTy> VarMap;
+  VarMap.reserve(From[Info::Vars].size());
+  for (auto &V : From[Info::Vars]) {
+    auto Itr{Vars.try_emplace(
+        VarKey{V[Var::File], V[Var::Line], V[Var::Column], V[Var::Name]},
+        ToVars.size())};
+    if (Itr.second)
+      ToVars.push_back(V);
+    VarMap.push_back(Itr.first->second);
+  }
+  auto &ToLoops{To[Info::Loops]};
+  std::map<LoopKey, std::size_t> Loops;
+  for (std::size_t I = 0, EI = ToLoops.size(); I < EI; ++I)
+    Loops.try_emplace(LoopKey{ToLoops[I][Loop::File], ToLoops[I][Loop::Line],
+                              ToLoops[I][Loop::Column]},
+                      I);
+  for (auto &L : From[Info::Loops]) {
+    auto Itr{Loops.try_emplace(
+        LoopKey{L[Loop::File], L[Loop::Line], L[Loop::Column]},
+        ToLoops.size())};
+    if (Itr.second)
+      ToLoops.push_back(remapLoop(L, VarMap));
+    else
+      mergeLoop(ToLoops[Itr.first->second], remapLoop(L, VarMap));
+  }
+  auto &ToFunctions{To[Info::Functions]};
+  std::map<FunctionKey, std::size_t> Functions;
+  for (std::size_t I = 0, EI = ToFunctions.size(); I < EI; ++I)
+    Functions.try_emplace(FunctionKey{ToFunctions[I][Function::File],
+                                      ToFunctions[I][Function::Line],
+                                      ToFunctions[I][Function::Name]},
+                          I);
+  for (auto &F : From[Info::Functions]) {
+    auto Itr{Functions.try_emplace(
+        FunctionKey{F[Function::File], F[Function::Line], F[Function::Name]},
+        ToFunctions.size())};
+    if (Itr.second)
+      ToFunctions.push_back(F);
+    else
+      ToFunctions[Itr.first->second][Function::Pure] =
+          ToFunctions[Itr.first->second][Function::Pure] && F[Function::Pure];
+  }
+}
+
+Info tsar::trait::mergeInfo(std::vector<Info> &&Runs, unsigned Jobs) {
+  if (Runs.empty())
+    return Info{};
+  if (Runs.size() > 2) {
+    // Each level of the tree merges pairs of results concurrently, results
+    // are merged in order of runs.
+    ThreadPool Pool(hardware_concurrency(Jobs));
+    for (std::size_t Step = 1; Step < Runs.size(); Step *= 2) {
+      for (std::size_t I = 0; I + Step < Runs.size(); I += 2 * Step)
+        Pool.async([&Runs, I, Step]() {
+          mergeInfo(Runs[I], Runs[I + Step]);
+          Runs[I + Step] = Info{};
+        });
+      Pool.wait();
+    }
+  } else if (Runs.size() == 2) {
+    mergeInfo(Runs[0], Runs[1]);
+  }
+  return std::move(Runs.front());
+}
@@ -28,25 +28,38 @@
 #include "tsar/Analysis/Memory/DIMemoryTrait.h"
 #include "tsar/Analysis/Memory/MemoryTraitJSON.h"
 #include "tsar/Analysis/Memory/Passes.h"
+#include "tsar/Analysis/Reader/AnalysisBinary.h"
 #include "tsar/Analysis/Reader/AnalysisJSON.h"
+#include "tsar/Analysis/Reader/AnalysisJSONStream.h"
+#include "tsar/Analysis/Reader/AnalysisMerge.h"
 #include "tsar/Analysis/Reader/Passes.h"
 #include "tsar/Support/GlobalOptions.h"
 #include "tsar/Support/MetadataUtils.h"
+#include "tsar/Support/OutputFile.h"
 #include "tsar/Support/Tags.h"
 #include "tsar/Unparse/SourceUnparserUtils.h"
 #include "tsar/Unparse/VariableLocation.h"
 #include <bcl/cell.h>
 #include <bcl/utility.h>
 #include <bcl/tagged.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSet.h>
 #include <llvm/IR/Function.h>
+#include <llvm/IR/DebugInfo.h>
 #include <llvm/IR/DebugInfoMetadata.h>
 #include <llvm/IR/DebugLoc.h>
 #include <llvm/IR/DiagnosticInfo.h>
+#include <llvm/IR/Module.h>
 #include <llvm/Pass.h>
+#include <llvm/Support/CommandLine.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Support/Debug.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/ThreadPool.h>
 #include <map>
+#include <mutex>
+#include <set>
 
 using namespace llvm;
 using namespace tsar;
@@ -54,6 +67,16 @@ using namespace tsar;
 #undef DEBUG_TYPE
 #define DEBUG_TYPE "analysis-reader"
 
+static cl::opt<unsigned> AnalysisMergeJobs(
+    "analysis-merge-jobs", cl::init(0), cl::Hidden,
+    cl::desc("Number of threads to merge multiple external analysis results "
+             "(0 means the number of available hardware threads)"));
+
+static cl::opt<std::string> AnalysisMergeOutput(
+    "analysis-merge-output", cl::Hidden, cl::value_desc("filename"),
+    cl::desc("Write merged external analysis results to a specified file "
+             "(binary format is used unless the file has .json extension)"));
+
 namespace {
 /// Position of a function in a source code.
 using FunctionT = bcl::tagged_tuple<
@@ -61,9 +84,18 @@ using FunctionT = bcl::tagged_tuple<
   bcl::tagged<trait::LineTy, Line>,
   bcl::tagged<std::string, Identifier>>;
 
-/// Map from a function location to a function index in the list of functions in
-/// external analysis results.
-using FunctionCache = std::map<FunctionT, std::size_t>;
+/// Raw representation of a record in external analysis results.
+///
+/// A record is parsed on the first access only.
+template<class T> struct RawRecord {
+  StringRef Raw;
+  std::unique_ptr<T> Parsed;
+  bool IsInvalid = false;
+};
+
+/// Map from a function location to a description of a function in external
+/// analysis results.
+using FunctionCache = std::map<FunctionT, RawRecord<trait::Function>>;
 
 /// Position in a source code.
 using LocationT = bcl::tagged_tuple<
@@ -71,9 +103,30 @@ using LocationT = bcl::tagged_tuple<
   bcl::tagged<trait::LineTy, Line>,
   bcl::tagged<trait::ColumnTy, Column>>;
 
-/// Map from a loop location to a loop index in a list of loops in
-/// external analysis results.
-using LoopCache = std::map<LocationT, std::size_t>;
+/// Map from a loop location to a description of a loop in external
+/// analysis results.
+using LoopCache = std::map<LocationT, RawRecord<trait::Loop>>;
+
+/// External analysis results loaded from a single file.
+///
+/// The file is mapped into memory and records point to the mapped buffer.
+struct ExternalResults {
+  std::string DataFile;
+  std::unique_ptr<trait::InfoStream> Stream;
+  FunctionCache Functions;
+  LoopCache Loops;
+  /// Raw representation of variables, a variable index is a position in
+  /// this list.
+  std::vector<StringRef> Vars;
+  /// Unique identifiers of files which are mentioned in results.
+  StringMap<Optional<sys::fs::UniqueID>> FileIDs;
+};
+
+/// Files and functions which are present in a module.
+struct ModuleInfo {
+  std::set<sys::fs::UniqueID> Files;
+  StringSet<> Names;
+};
 
 /// Tuple of iterators of variable traits stored in external analysis results.
 using TraitT = bcl::tagged_tuple<
@@ -159,64 +212,87 @@ public:
   }
 
   bool runOnFunction(Function &F) override;
+  bool doFinalization(Module &M) override;
   void getAnalysisUsage(AnalysisUsage &AU) const override;
 
 private:
-  bool load(Function &F, unsigned DWLang, StringRef DataFile);
+  /// Scan a specified file and remember records which may be interesting
+  /// for a specified module.
+  std::unique_ptr<ExternalResults> load(Module &M, const ModuleInfo &MI,
+                                        StringRef DataFile);
+
+  /// Load multiple files concurrently and merge them into a single result.
+  ///
+  /// Files are merged on the first call only, records which may be interesting
+  /// for a specified module are remembered.
+  std::unique_ptr<ExternalResults> loadMerged(Module &M, const ModuleInfo &MI,
+      ArrayRef<std::string> DataFiles);
+
+  /// Merge specified files and store results in binary format to `Buffer`.
+  void merge(Module &M, ArrayRef<std::string> DataFiles, std::string &Buffer);
+
+  /// Update traits in a pool according to external analysis results.
+  void update(unsigned DWLang, ExternalResults &Results, LLVMContext &Ctx);
+
+  std::vector<std::unique_ptr<ExternalResults>> mResults;
+  bool mIsLoaded = false;
 };
 
-/// Extract a list of analyzed functions from external analysis results.
-FunctionCache buildFunctionCache(const trait::Info &Info) {
-    FunctionCache Res;
-  for (std::size_t I = 0, EI = Info[trait::Info::Functions].size(); I < EI;
-       ++I) {
-    auto &F = Info[trait::Info::Functions][I];
-    LLVM_DEBUG(dbgs() << "[ANALYSIS READER]: add function to cache "
-                      << F[trait::Function::Name] << ":"
-                      << F[trait::Function::File] << ":"
-                      << F[trait::Function::Line] << ":"
-                      << F[trait::Function::Column] << "\n");
+/// Return unique identifier of a file mentioned in external analysis results.
+Optional<sys::fs::UniqueID> getFileID(StringRef File,
+                                      ExternalResults &Results) {
+  auto Itr{Results.FileIDs.try_emplace(File)};
+  if (Itr.second) {
     sys::fs::UniqueID ID;
-    if (sys::fs::getUniqueID(F[trait::Function::File], ID))
-      continue;
-    Res.emplace(
-        FunctionT{ID, F[trait::Function::Line], F[trait::Function::Name]}, I);
+    if (!sys::fs::getUniqueID(File, ID))
+      Itr.first->second = ID;
   }
-  return Res;
+  return Itr.first->second;
 }
 
-/// Extract a list of analyzed loops from external analysis results.
-LoopCache buildLoopCache(const trait::Info &Info) {
-  LoopCache Res;
-  for (std::size_t I = 0, EI = Info[trait::Info::Loops].size(); I < EI; ++I) {
-    auto &L = Info[trait::Info::Loops][I];
-    LLVM_DEBUG(dbgs() << "[ANALYSIS READER]: add loop to cache "
-      << L[trait::Loop::File] << ":" << L[trait::Loop::Line]
-      << ":" << L[trait::Loop::Column] << "\n");
-    sys::fs::UniqueID ID;
-    if (sys::fs::getUniqueID(L[trait::Loop::File], ID))
-      continue;
-    Res.emplace(LocationT{ID, L[trait::Loop::Line], L[trait::Loop::Column]}, I);
+/// Parse a specified record if it has not been parsed yet.
+template<class T> const T *materialize(RawRecord<T> &R,
+    const ExternalResults &Results, LLVMContext &Ctx) {
+  if (R.Parsed || R.IsInvalid)
+    return R.Parsed.get();
+  auto Obj{std::make_unique<T>()};
+  trait::InfoStream::ErrorList Errors;
+  if (!Results.Stream->parse(R.Raw, *Obj, Errors)) {
+    R.IsInvalid = true;
+    for (auto &D : Errors) {
+      // Build diagnostic in-place of call to diagnose(), because diagnostic
+      // class uses temporary objects available only at construction time.
+      Ctx.diagnose(
+          DiagnosticInfoPGOProfile(Results.DataFile.data(), D, DS_Note));
+    }
+    Ctx.diagnose(DiagnosticInfoPGOProfile(Results.DataFile.data(),
+      "unable to parse external analysis results"));
+    return nullptr;
   }
-  return Res;
+  R.Parsed = std::move(Obj);
+  return R.Parsed.get();
 }
 
-VariableLocationT createVar(trait::IdTy I, const trait::Info &Info) {
-  /// TODO (kaniandr@gmail.com): check that index of variable is not out of
-  /// range due to incorrect .json created manually.
+VariableLocationT createVar(trait::IdTy I, ExternalResults &Results) {
   VariableLocationT Var;
-  sys::fs::UniqueID ID;
-  if (sys::fs::getUniqueID(Info[trait::Info::Vars][I][trait::Var::File], ID)) {
-    LLVM_DEBUG(dbgs() << "[ANALYSIS READER]: ignore variable "
-                      << Info[trait::Info::Vars][I][trait::Var::Name]
-                      << ", unable to build unique ID for a file "
-                      << Info[trait::Info::Vars][I][trait::Var::File] << "\n");
+  trait::InfoStream::Record R;
+  if (I >= Results.Vars.size() ||
+      !Results.Stream->readRecord(Results.Vars[I], R)) {
+    LLVM_DEBUG(dbgs() << "[ANALYSIS READER]: ignore variable " << I
+                      << ", description is not available\n");
+    return Var;
+  }
+  auto ID{getFileID(R.File, Results)};
+  if (!ID) {
+    LLVM_DEBUG(dbgs() << "[ANALYSIS READER]: ignore variable " << R.Name
+                      << ", unable to build unique ID for a file " << R.File
+                      << "\n");
     return Var;
   }
-  Var.get<File>() = ID;
-  Var.get<Line>() = Info[trait::Info::Vars][I][trait::Var::Line];
-  Var.get<Column>() = Info[trait::Info::Vars][I][trait::Var::Column];
-  Var.get<Identifier>() = Info[trait::Info::Vars][I][trait::Var::Name];
+  Var.get<File>() = *ID;
+  Var.get<Line>() = R.Line;
+  Var.get<Column>() = R.Column;
+  Var.get<Identifier>() = std::move(R.Name);
   return Var;
 }
 
@@ -236,9 +312,9 @@ trait::IdTy getVariableIdx(
 }
 
 template<class Tag, class ExternalTag> void addToCache(ExternalTag Key,
-    const trait::Info &Info, const trait::Loop &L, TraitCache &Cache) {
+    ExternalResults &Results, const trait::Loop &L, TraitCache &Cache) {
   for (auto I = L[Key].cbegin(), EI = L[Key].cend(); I != EI; ++I) {
-    auto Var = createVar(getVariableIdx(I), Info);
+    auto Var = createVar(getVariableIdx(I), Results);
     if (Var.template get<Identifier>().empty())
       continue;
     auto CacheItr = Cache.find(Var);
@@ -250,39 +326,39 @@ template<class Tag, class ExternalTag> void addToCache(ExternalTag Key,
 
 /// Extract a list of traits for a specified loop `L` from external analysis
 /// results.
-TraitCache buildTraitCache(const trait::Info &Info, const trait::Loop &L) {
+TraitCache buildTraitCache(ExternalResults &Results, const trait::Loop &L) {
   TraitCache Res;
-  addToCache<trait::Reduction>(trait::Loop::Reduction, Info, L, Res);
-  addToCache<trait::Private>(trait::Loop::Private, Info, L, Res);
-  addToCache<trait::UseAfterLoop>(trait::Loop::UseAfterLoop, Info, L, Res);
-  addToCache<trait::WriteOccurred>(trait::Loop::WriteOccurred, Info, L, Res);
-  addToCache<trait::ReadOccurred>(trait::Loop::ReadOccurred, Info, L, Res);
-  addToCache<trait::Output>(trait::Loop::Output, Info, L, Res);
-  addToCache<trait::Anti>(trait::Loop::Anti, Info, L, Res);
-  addToCache<trait::Flow>(trait::Loop::Flow, Info, L, Res);
+  addToCache<trait::Reduction>(trait::Loop::Reduction, Results, L, Res);
+  addToCache<trait::Private>(trait::Loop::Private, Results, L, Res);
+  addToCache<trait::UseAfterLoop>(trait::Loop::UseAfterLoop, Results, L, Res);
+  addToCache<trait::WriteOccurred>(trait::Loop::WriteOccurred, Results, L, Res);
+  addToCache<trait::ReadOccurred>(trait::Loop::ReadOccurred, Results, L, Res);
+  addToCache<trait::Output>(trait::Loop::Output, Results, L, Res);
+  addToCache<trait::Anti>(trait::Loop::Anti, Results, L, Res);
+  addToCache<trait::Flow>(trait::Loop::Flow, Results, L, Res);
   return Res;
 }
 
 const trait::Function *findFunction(const DISubprogram *DISub,
-    const FunctionCache &Cache, const trait::Info &Info) {
+    ExternalResults &Results, LLVMContext &Ctx) {
   SmallString<128> Path;
   sys::fs::UniqueID ID;
   if (sys::fs::getUniqueID(getAbsolutePath(*DISub, Path), ID))
     return nullptr;
   FunctionT F{ID, DISub->getLine(), DISub->getName()};
-  auto FuncItr = Cache.find(F);
-  if (FuncItr != Cache.end())
-    return &Info[trait::Info::Functions][FuncItr->second];
+  auto FuncItr = Results.Functions.find(F);
+  if (FuncItr != Results.Functions.end())
+    return materialize(FuncItr->second, Results, Ctx);
   F.get<Identifier>() = DISub->getLinkageName().str();
-  FuncItr = Cache.find(F);
-  return (FuncItr == Cache.end())
+  FuncItr = Results.Functions.find(F);
+  return (FuncItr == Results.Functions.end())
              ? nullptr
-             : &Info[trait::Info::Functions][FuncItr->second];
+             : materialize(FuncItr->second, Results, Ctx);
 }
 
 /// Find traits for a specified loop in external analysis results.
-const trait::Loop * findLoop(const MDNode *LoopID, const LoopCache &Cache,
-    const trait::Info &Info) {
+const trait::Loop * findLoop(const MDNode *LoopID, ExternalResults &Results,
+    LLVMContext &Ctx) {
   DILocation *Loc = nullptr;
   for (unsigned I = 1, EI = LoopID->getNumOperands(); I < EI; ++I)
     if (Loc = dyn_cast<DILocation>(LoopID->getOperand(I)))
@@ -295,9 +371,9 @@ const trait::Loop * findLoop(const MDNode *LoopID, const LoopCache &Cache,
     return nullptr;
   auto LoopKey =
     LocationT{ ID, Loc->getLine(), Loc->getColumn() };
-  auto LoopItr = Cache.find(LoopKey);
-  return (LoopItr == Cache.end() ? nullptr :
-    &Info[trait::Info::Loops][LoopItr->second]);
+  auto LoopItr = Results.Loops.find(LoopKey);
+  return (LoopItr == Results.Loops.end() ? nullptr :
+    materialize(LoopItr->second, Results, Ctx));
 }
 
 /// Update description `DITrait` of a specified trait `TraitTag` according to
@@ -355,6 +431,136 @@ void updateOutputDep(
     DistVector[I] = Dep->getDistance(I);
   DITrait.template set<trait::Output>(new trait::DIDependence(F, DistVector));
 }
+
+/// Collect files and functions which are present in a module. Records which
+/// describe other files and functions are skipped.
+ModuleInfo collectModuleInfo(Module &M) {
+  ModuleInfo MI;
+  StringSet<> Paths;
+  auto addFile = [&MI, &Paths](const DIScope &Scope) {
+    SmallString<128> Path;
+    getAbsolutePath(Scope, Path);
+    if (!Paths.insert(Path).second)
+      return;
+    sys::fs::UniqueID ID;
+    if (!sys::fs::getUniqueID(Path, ID))
+      MI.Files.insert(ID);
+  };
+  DebugInfoFinder Finder;
+  Finder.processModule(M);
+  for (auto *CU : Finder.compile_units())
+    addFile(*CU);
+  for (auto *Scope : Finder.scopes())
+    addFile(*Scope);
+  for (auto *SP : Finder.subprograms()) {
+    addFile(*SP);
+    MI.Names.insert(SP->getName());
+    if (!SP->getLinkageName().empty())
+      MI.Names.insert(SP->getLinkageName());
+  }
+  for (auto &F : M)
+    MI.Names.insert(F.getName());
+  return MI;
+}
+
+/// Scan external analysis results and remember records which may be
+/// interesting for a module.
+bool scan(const ModuleInfo &MI, ExternalResults &Results) {
+  return Results.Stream->scan(
+      [&MI, &Results](trait::InfoStream::RecordKind Kind,
+                      const trait::InfoStream::Record &R) {
+        switch (Kind) {
+        case trait::InfoStream::RecordKind::Var:
+          Results.Vars.push_back(R.Raw);
+          break;
+        case trait::InfoStream::RecordKind::Function: {
+          if (!MI.Names.count(R.Name))
+            return;
+          auto ID{getFileID(R.File, Results)};
+          if (!ID)
+            return;
+          LLVM_DEBUG(dbgs() << "[ANALYSIS READER]: add function to cache "
+                            << R.Name << ":" << R.File << ":" << R.Line << ":"
+                            << R.Column << "\n");
+          auto Itr{Results.Functions.try_emplace(
+              FunctionT{*ID, R.Line, R.Name})};
+          if (Itr.second)
+            Itr.first->second.Raw = R.Raw;
+          break;
+        }
+        case trait::InfoStream::RecordKind::Loop: {
+          auto ID{getFileID(R.File, Results)};
+          if (!ID)
+            return;
+          LLVM_DEBUG(dbgs() << "[ANALYSIS READER]: add loop to cache "
+                            << R.File << ":" << R.Line << ":" << R.Column
+                            << "\n");
+          auto Itr{Results.Loops.try_emplace(
+              LocationT{*ID, R.Line, R.Column})};
+          if (Itr.second)
+            Itr.first->second.Raw = R.Raw;
+          break;
+        }
+        }
+      },
+      [&MI, &Results](trait::InfoStream::RecordKind Kind, StringRef File) {
+        if (Kind != trait::InfoStream::RecordKind::Loop)
+          return true;
+        auto ID{getFileID(File, Results)};
+        return ID && MI.Files.count(*ID);
+      });
+}
+
+/// Materialize all records from a specified stream, variables keep their
+/// indices.
+///
+/// Return false if the stream is malformed.
+bool materializeAll(trait::InfoStream &Stream, trait::Info &Info,
+                    trait::InfoStream::ErrorList &Errors) {
+  return Stream.scan(
+      [&Stream, &Info, &Errors](trait::InfoStream::RecordKind Kind,
+                                const trait::InfoStream::Record &R) {
+        switch (Kind) {
+        case trait::InfoStream::RecordKind::Var: {
+          trait::InfoStream::Record VarR;
+          auto &V{Info[trait::Info::Vars].emplace_back()};
+          if (!Stream.readRecord(R.Raw, VarR))
+            return;
+          V[trait::Var::File] = std::move(VarR.File);
+          V[trait::Var::Line] = VarR.Line;
+          V[trait::Var::Column] = VarR.Column;
+          V[trait::Var::Name] = std::move(VarR.Name);
+          break;
+        }
+        case trait::InfoStream::RecordKind::Function: {
+          trait::Function Obj;
+          if (Stream.parse(R.Raw, Obj, Errors))
+            Info[trait::Info::Functions].push_back(std::move(Obj));
+          break;
+        }
+        case trait::InfoStream::RecordKind::Loop: {
+          trait::Loop Obj;
+          if (Stream.parse(R.Raw, Obj, Errors))
+            Info[trait::Info::Loops].push_back(std::move(Obj));
+          break;
+        }
+        }
+      },
+      [](trait::InfoStream::RecordKind, StringRef) { return true; });
+}
+
+/// External analysis results merged from multiple files.
+///
+/// Files are merged once per process without filtering by module, so
+/// all modules share merged results and -analysis-merge-output file contains
+/// results for the whole program.
+struct MergedResults {
+  std::mutex Lock;
+  std::vector<std::string> DataFiles;
+
+  /// Merged results in binary format.
+  std::string Buffer;
+};
 }
 
 INITIALIZE_PASS_BEGIN(AnalysisReader, "analysis-reader",
@@ -377,55 +583,164 @@ bool AnalysisReader::runOnFunction(Function &F) {
   auto DWLang = getLanguage(F);
   if (!DWLang)
     return false;
-  auto &GO{getAnalysis<GlobalOptionsImmutableWrapper>().getOptions()};
-  for (auto &File : GO.AnalysisUse)
-    load(F, *DWLang, File);
+  if (!mIsLoaded) {
+    // Each file is scanned once per module, records are materialized lazily
+    // when traits of an appropriate loop or function are updated.
+    auto &GO{getAnalysis<GlobalOptionsImmutableWrapper>().getOptions()};
+    auto MI{collectModuleInfo(*F.getParent())};
+    if (GO.AnalysisUse.size() > 1) {
+      if (auto Results{loadMerged(*F.getParent(), MI, GO.AnalysisUse)})
+        mResults.push_back(std::move(Results));
+    } else {
+      for (auto &File : GO.AnalysisUse)
+        if (auto Results{load(*F.getParent(), MI, File)})
+          mResults.push_back(std::move(Results));
+    }
+    mIsLoaded = true;
+  }
+  for (auto &Results : mResults)
+    update(*DWLang, *Results, F.getContext());
+  return false;
+}
+
+bool AnalysisReader::doFinalization(Module &M) {
+  mResults.clear();
+  mIsLoaded = false;
   return false;
 }
 
-bool AnalysisReader::load(Function &F, unsigned DWLang, StringRef DataFile) {
+std::unique_ptr<ExternalResults> AnalysisReader::load(Module &M,
+    const ModuleInfo &MI, StringRef DataFile) {
   LLVM_DEBUG(
       dbgs() << "[ANALYSIS READER]: load external analysis results from '"
              << DataFile << "'\n");
-  auto FileOrErr = MemoryBuffer::getFile(DataFile);
-  if (auto EC = FileOrErr.getError()) {
-    F.getContext().diagnose(DiagnosticInfoPGOProfile(DataFile.data(),
+  auto StreamOrErr{trait::InfoStream::open(DataFile)};
+  if (auto EC = StreamOrErr.getError()) {
+    M.getContext().diagnose(DiagnosticInfoPGOProfile(DataFile.data(),
       Twine("unable to open file: ") + EC.message()));
-    return false;
+    return nullptr;
   }
-  auto &TraitPool = getAnalysis<DIMemoryTraitPoolWrapper>().get();
-  json::Parser<> Parser((**FileOrErr).getBuffer().str());
-  trait::Info Info;
-  if (!Parser.parse(Info)) {
-    for (auto D : Parser.errors()) {
-      // Build diagnostic in-place of call to diagnose(), because diagnostic
-      // class uses temporary objects available only at construction time.
-      F.getContext().diagnose(
-          DiagnosticInfoPGOProfile(DataFile.data(), D, DS_Note));
-    }
-    F.getContext().diagnose(DiagnosticInfoPGOProfile(DataFile.data(),
+  auto Results{std::make_unique<ExternalResults>()};
+  Results->DataFile = DataFile.str();
+  Results->Stream = std::move(*StreamOrErr);
+  if (!scan(MI, *Results)) {
+    M.getContext().diagnose(DiagnosticInfoPGOProfile(
+        DataFile.data(), Results->Stream->getError(), DS_Note));
+    M.getContext().diagnose(DiagnosticInfoPGOProfile(DataFile.data(),
       "unable to parse external analysis results"));
-    return false;
+    return nullptr;
   }
-  auto FunctionCache = buildFunctionCache(Info);
-  auto LoopCache = buildLoopCache(Info);
+  return Results;
+}
+
+std::unique_ptr<ExternalResults> AnalysisReader::loadMerged(Module &M,
+    const ModuleInfo &MI, ArrayRef<std::string> DataFiles) {
+  static MergedResults Merged;
+  auto Results{std::make_unique<ExternalResults>()};
+  Results->DataFile = "<merged analysis results>";
+  {
+    // Modules may be analyzed in parallel, so all of them wait for the merge.
+    std::lock_guard<std::mutex> Lock(Merged.Lock);
+    if (Merged.DataFiles.size() != DataFiles.size() ||
+        !std::equal(DataFiles.begin(), DataFiles.end(),
+                    Merged.DataFiles.begin())) {
+      merge(M, DataFiles, Merged.Buffer);
+      Merged.DataFiles.assign(DataFiles.begin(), DataFiles.end());
+    }
+    // Merged results are stored in binary format in memory, so they are
+    // accessed in the same way as results loaded from a single file.
+    Results->Stream = std::make_unique<trait::BinaryInfoStream>(
+        MemoryBuffer::getMemBufferCopy(Merged.Buffer, Results->DataFile));
+  }
+  if (!scan(MI, *Results)) {
+    M.getContext().diagnose(DiagnosticInfoPGOProfile(
+        Results->DataFile.data(), Results->Stream->getError()));
+    return nullptr;
+  }
+  return Results;
+}
+
+void AnalysisReader::merge(Module &M, ArrayRef<std::string> DataFiles,
+                           std::string &Buffer) {
+  // Files are loaded concurrently, diagnostics are emitted later because
+  // LLVMContext is not thread-safe.
+  unsigned Jobs = AnalysisMergeJobs;
+#ifndef NDEBUG
+  // Debug output for different files must not be interleaved.
+  if (DebugFlag && isCurrentDebugType(DEBUG_TYPE))
+    Jobs = 1;
+#endif
+  std::vector<trait::Info> Runs(DataFiles.size());
+  std::vector<trait::InfoStream::ErrorList> Errors(DataFiles.size());
+  {
+    ThreadPool Pool(hardware_concurrency(Jobs));
+    for (std::size_t I = 0, EI = DataFiles.size(); I < EI; ++I)
+      Pool.async([&DataFiles, &Runs, &Errors, I]() {
+        auto StreamOrErr{trait::InfoStream::open(DataFiles[I])};
+        if (auto EC = StreamOrErr.getError()) {
+          Errors[I].push_back("unable to open file: " + EC.message());
+          return;
+        }
+        auto &Stream{**StreamOrErr};
+        if (!materializeAll(Stream, Runs[I], Errors[I])) {
+          Errors[I].push_back(Stream.getError().str());
+          Errors[I].push_back("unable to parse external analysis results");
+        }
+      });
+    Pool.wait();
+  }
+  for (std::size_t I = 0, EI = DataFiles.size(); I < EI; ++I)
+    for (std::size_t D = 0, ED = Errors[I].size(); D < ED; ++D)
+      M.getContext().diagnose(DiagnosticInfoPGOProfile(DataFiles[I].data(),
+        Errors[I][D], D + 1 < ED ? DS_Note : DS_Error));
+  auto Info{trait::mergeInfo(std::move(Runs), Jobs)};
+  Buffer.clear();
+  raw_string_ostream OS(Buffer);
+  trait::writeBinaryInfo(Info, OS);
+  OS.flush();
+  if (AnalysisMergeOutput.empty())
+    return;
+  bool IsJSON{sys::path::extension(AnalysisMergeOutput) == ".json"};
+  auto OF{OutputFile::create(AnalysisMergeOutput, !IsJSON)};
+  if (!OF) {
+    M.getContext().diagnose(DiagnosticInfoPGOProfile(
+        AnalysisMergeOutput.data(),
+        Twine("unable to open file: ") +
+            errorToErrorCode(OF.takeError()).message()));
+    return;
+  }
+  if (IsJSON)
+    OF->getStream() << json::Parser<trait::Info>::unparseAsObject(Info);
+  else
+    OF->getStream() << Buffer;
+  if (auto E{OF->clear()}) {
+    std::string Msg;
+    raw_string_ostream{Msg} << E;
+    M.getContext().diagnose(DiagnosticInfoPGOProfile(
+        AnalysisMergeOutput.data(), Twine("unable to write file: ") + Msg));
+  }
+}
+
+void AnalysisReader::update(unsigned DWLang, ExternalResults &Results,
+                            LLVMContext &Ctx) {
+  auto &TraitPool = getAnalysis<DIMemoryTraitPoolWrapper>().get();
   for (auto &TraitLoop : TraitPool) {
     auto LoopID = cast<MDNode>(TraitLoop.get<Region>());
-    auto *L = findLoop(LoopID, LoopCache, Info);
+    auto *L = findLoop(LoopID, Results, Ctx);
     if (!L)
       continue;
     LLVM_DEBUG(dbgs() << "[ANALYSIS READER]: update traits for loop at "
                       << (*L)[trait::Loop::File] << ":"
                       << (*L)[trait::Loop::Line] << ":"
                       << (*L)[trait::Loop::Column] << "\n");
-    auto TraitCache = buildTraitCache(Info, *L);
+    auto TraitCache = buildTraitCache(Results, *L);
     for (auto &DITrait : *TraitLoop.get<Pool>()) {
       if (auto *DIUM{ dyn_cast<DIUnknownMemory>(DITrait.getMemory()) };
           DIUM && DIUM->isExec()) {
         auto *MD{DIUM->getMetadata()};
         assert(MD && "MDNode must not be null!");
         if (auto *DISub{dyn_cast<DISubprogram>(MD)})
-          if (auto *F{findFunction(DISub, FunctionCache, Info)}) {
+          if (auto *F{findFunction(DISub, Results, Ctx)}) {
             LLVM_DEBUG(dbgs() << "[ANALYSIS READER]: update traits for the "
                               << (*F)[trait::Function::Name] << " function at "
                               << (*F)[trait::Function::File] << ":"
@@ -506,5 +821,4 @@ bool AnalysisReader::load(Function &F, unsigned DWLang, StringRef DataFile) {
                  DITrait.print(dbgs()); dbgs() << "\n");
     }
   }
-  return true;
 }
@@ -25,6 +25,7 @@
 #include "tsar/Analysis/Memory/DIMemoryTrait.h"
 #include "tsar/Analysis/Memory/MemoryTraitJSON.h"
 #include "tsar/Analysis/Memory/Utils.h"
+#include "tsar/Analysis/Reader/AnalysisBinary.h"
 #include "tsar/Analysis/Reader/AnalysisJSON.h"
 #include "tsar/Analysis/Reader/Passes.h"
 #include "tsar/Core/Query.h"
@@ -38,10 +39,16 @@
 #include <llvm/Analysis/LoopInfo.h>
 #include <llvm/InitializePasses.h>
 #include <llvm/Pass.h>
+#include <llvm/Support/CommandLine.h>
 
 using namespace llvm;
 using namespace tsar;
 
+static cl::opt<bool> BinaryAnalysisOutput("print-analysis-binary",
+  cl::init(false), cl::Hidden,
+  cl::desc("Write analysis results in a compact binary format "
+           "instead of JSON"));
+
 namespace {
 class AnalysisWriter : public ModulePass, private bcl::Uncopyable {
 public:
@@ -59,8 +66,9 @@ public:
 
 
 bool AnalysisWriter::runOnModule(Module &M) {
-  std::string DataFile{"analysis.json"};
-  auto OF{OutputFile::create(DataFile, false)};
+  std::string DataFile{BinaryAnalysisOutput ? "analysis.bin"
+                                             : "analysis.json"};
+  auto OF{OutputFile::create(DataFile, BinaryAnalysisOutput)};
   if (!OF) {
     M.getContext().diagnose(DiagnosticInfoPGOProfile(
         DataFile.data(), Twine("unable to open file: ") +
@@ -217,7 +225,10 @@ bool AnalysisWriter::runOnModule(Module &M) {
     });
   }
   errs() << "Writing '" << DataFile << "'...\n";
-  OF->getStream() << json::Parser<trait::Info>::unparseAsObject(Info);
+  if (BinaryAnalysisOutput)
+    trait::writeBinaryInfo(Info, OF->getStream());
+  else
+    OF->getStream() << json::Parser<trait::Info>::unparseAsObject(Info);
   if (auto E{OF->clear()}) {
     std::string Msg;
     raw_string_ostream{Msg} << E;
@@ -0,0 +1,200 @@
+//===- AnalysisCache.cpp --- Analysis Results Cache -------------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a persistent on-disk cache of analysis results for
+// translation units.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tsar/Core/AnalysisCache.h"
+#include "tsar/Core/tsar-config.h"
+#include "tsar/Support/OutputFile.h"
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/FrontendActions.h>
+#include <clang/Lex/Preprocessor.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/Support/EndianStream.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/VirtualFileSystem.h>
+
+using namespace clang;
+using namespace clang::tooling;
+using namespace llvm;
+using namespace tsar;
+
+namespace {
+/// Magic number which identifies a cache entry.
+constexpr char EntryMagic[] = {'T', 'S', 'A', 'R', 'C', 'A', 'C', 'H'};
+
+/// Version of a format of a cache entry. It should be incremented each time
+/// the format is changed.
+constexpr uint32_t EntryVersion = 1;
+
+/// This computes hash of preprocessed tokens of the main file.
+///
+/// Locations of tokens are also taken into account, because cached
+/// diagnostics refer to them.
+class PreprocessedHashAction : public PreprocessorFrontendAction {
+public:
+  explicit PreprocessedHashAction(MD5 &Hash) : mHash(Hash) {}
+
+  void ExecuteAction() override {
+    auto &PP = getCompilerInstance().getPreprocessor();
+    auto &SM = PP.getSourceManager();
+    PP.EnterMainSourceFile();
+    Token Tok;
+    SmallString<64> Buffer;
+    do {
+      PP.Lex(Tok);
+      auto Spelling = PP.getSpelling(Tok, Buffer);
+      mHash.update(Spelling);
+      // Separate tokens to distinguish `a b` and `ab`.
+      mHash.update(ArrayRef<uint8_t>(static_cast<uint8_t>(Tok.getKind())));
+      updateLoc(SM, Tok.getLocation());
+      if (Tok.getLocation().isMacroID())
+        updateLoc(SM, SM.getSpellingLoc(Tok.getLocation()));
+    } while (Tok.isNot(tok::eof));
+  }
+
+private:
+  void updateLoc(const SourceManager &SM, SourceLocation Loc) {
+    auto PLoc = SM.getPresumedLoc(Loc);
+    if (PLoc.isInvalid()) {
+      mHash.update(ArrayRef<uint8_t>{0});
+      return;
+    }
+    mHash.update(PLoc.getFilename());
+    uint8_t Pos[sizeof(uint32_t) * 2];
+    support::endian::write32le(Pos, PLoc.getLine());
+    support::endian::write32le(Pos + sizeof(uint32_t), PLoc.getColumn());
+    mHash.update(Pos);
+  }
+
+  MD5 &mHash;
+};
+
+class PreprocessedHashActionFactory : public FrontendActionFactory {
+public:
+  explicit PreprocessedHashActionFactory(MD5 &Hash) : mHash(Hash) {}
+
+  std::unique_ptr<FrontendAction> create() override {
+    return std::make_unique<PreprocessedHashAction>(mHash);
+  }
+
+private:
+  MD5 &mHash;
+};
+}
+
+Optional<std::string>
+AnalysisCache::computeKey(const CompilationDatabase &Compilations,
+                          StringRef Source, ArrayRef<std::string> ToolOptions) {
+  MD5 Hash;
+  Hash.update(TSAR_VERSION_STRING);
+  for (auto &Opt : ToolOptions) {
+    Hash.update(Opt);
+    Hash.update(ArrayRef<uint8_t>{0});
+  }
+  for (auto &Cmd : Compilations.getCompileCommands(Source)) {
+    Hash.update(Cmd.Directory);
+    for (auto &Arg : Cmd.CommandLine) {
+      Hash.update(Arg);
+      Hash.update(ArrayRef<uint8_t>{0});
+    }
+  }
+  ClangTool PPTool(Compilations, Source,
+                   std::make_shared<PCHContainerOperations>(),
+                   vfs::createPhysicalFileSystem());
+  IgnoringDiagConsumer DiagConsumer;
+  PPTool.setDiagnosticConsumer(&DiagConsumer);
+  PreprocessedHashActionFactory Factory(Hash);
+  if (PPTool.run(&Factory) != 0)
+    return None;
+  MD5::MD5Result Result;
+  Hash.final(Result);
+  return Result.digest().str().str();
+}
+
+std::string AnalysisCache::hashFiles(ArrayRef<std::string> Files) {
+  MD5 Hash;
+  for (auto &File : Files) {
+    Hash.update(File);
+    Hash.update(ArrayRef<uint8_t>{0});
+    // Hash of a file which cannot be read differs from hash of an empty file.
+    if (auto Buffer = MemoryBuffer::getFile(File, false, false)) {
+      Hash.update(ArrayRef<uint8_t>{1});
+      Hash.update((*Buffer)->getBuffer());
+    } else {
+      Hash.update(ArrayRef<uint8_t>{0});
+    }
+  }
+  MD5::MD5Result Result;
+  Hash.final(Result);
+  return Result.digest().str().str();
+}
+
+Optional<AnalysisCacheEntry> AnalysisCache::lookup(StringRef Key) const {
+  SmallString<128> Path{mDir};
+  sys::path::append(Path, Key);
+  auto Buffer = MemoryBuffer::getFile(Path, false, false);
+  if (!Buffer)
+    return None;
+  StringRef Data = (*Buffer)->getBuffer();
+  constexpr auto HeaderSize =
+      sizeof(EntryMagic) + sizeof(uint32_t) * 2 + sizeof(uint64_t);
+  if (Data.size() < HeaderSize ||
+      !Data.startswith(StringRef(EntryMagic, sizeof(EntryMagic))))
+    return None;
+  const char *Ptr = Data.data() + sizeof(EntryMagic);
+  using namespace support;
+  if (endian::readNext<uint32_t, little, unaligned>(Ptr) != EntryVersion)
+    return None;
+  AnalysisCacheEntry Entry;
+  Entry.Result = endian::readNext<uint32_t, little, unaligned>(Ptr);
+  auto Size = endian::readNext<uint64_t, little, unaligned>(Ptr);
+  if (Data.size() - HeaderSize != Size)
+    return None;
+  Entry.Output.assign(Ptr, Size);
+  return Entry;
+}
+
+Error AnalysisCache::store(StringRef Key,
+                           const AnalysisCacheEntry &Entry) const {
+  if (auto EC = sys::fs::create_directories(mDir))
+    return errorCodeToError(EC);
+  SmallString<128> Path{mDir};
+  sys::path::append(Path, Key);
+  // A temporary file is used, so concurrent processes never observe
+  // partially written entries.
+  auto OF = OutputFile::create(Path);
+  if (!OF)
+    return OF.takeError();
+  auto &OS = OF->getStream();
+  OS.write(EntryMagic, sizeof(EntryMagic));
+  support::endian::Writer Writer(OS, support::little);
+  Writer.write<uint32_t>(EntryVersion);
+  Writer.write<uint32_t>(Entry.Result);
+  Writer.write<uint64_t>(Entry.Output.size());
+  OS << Entry.Output;
+  return OF->clear();
+}
@@ -29,6 +29,7 @@
 #include "tsar/Analysis/Passes.h"
 #include "tsar/Analysis/Reader/Passes.h"
 #include "tsar/Analysis/Memory/AllocasModRef.h"
+#include "tsar/Analysis/Memory/TieredAA.h"
 #ifdef APC_FOUND
 # include "tsar/APC/Passes.h"
 # include "tsar/APC/Utils.h"
@@ -73,6 +74,13 @@ using namespace clang;
 using namespace llvm;
 using namespace tsar;
 
+static cl::opt<bool> TieredAliasAnalysis("use-tiered-aa", cl::init(false),
+  cl::Hidden,
+  cl::desc("Use Andersen's alias analysis only for functions where aliasing "
+           "prevents parallelization of loops (a function is reanalyzed at "
+           "the next processing steps only, results of the step which "
+           "detects aliasing are not recomputed)"));
+
 namespace tsar {
 void printToolVersion(raw_ostream &OS) {
   OS << "TSAR (" << TSAR_HOMEPAGE_URL << "):\n";
@@ -101,7 +109,12 @@ void printToolVersion(raw_ostream &OS) {
 
 void addImmutableAliasAnalysis(legacy::PassManager &Passes) {
   Passes.add(createCFLSteensAAWrapperPass());
-  Passes.add(createCFLAndersAAWrapperPass());
+  // In tiered mode Andersen's analysis is accessed through TieredAA which
+  // builds graphs for escalated functions only.
+  if (TieredAliasAnalysis)
+    Passes.add(createTieredAAWrapperPass());
+  else
+    Passes.add(createCFLAndersAAWrapperPass());
   Passes.add(createTypeBasedAAWrapperPass());
   Passes.add(createScopedNoAliasAAWrapperPass());
   Passes.add(createAllocasAAWrapperPass());
@@ -111,6 +124,10 @@ void addImmutableAliasAnalysis(legacy::PassManager &Passes) {
           AAP->getResult().analyzeFunction(F);
           AAR.addAAResult(AAP->getResult());
         }
+        // This must be the last one, so it is queried only if other analyses
+        // return MayAlias.
+        if (auto AAP = P.getAnalysisIfAvailable<TieredAAWrapperPass>())
+          AAR.addAAResult(AAP->getResult());
       }));
 }
 
@@ -147,8 +164,9 @@ void addInitialTransformations(legacy::PassManager &Passes) {
 }
 
 void addBeforeTfmAnalysis(legacy::PassManager &Passes, StringRef AnalysisUse) {
-  Passes.add(createGlobalsAccessCollector());
   Passes.add(createCallExtractorPass());
+  Passes.add(createFunctionChangeTracker());
+  Passes.add(createGlobalsAccessCollector());
   Passes.add(createGlobalDefinedMemoryPass());
   Passes.add(createGlobalLiveMemoryPass());
   Passes.add(createFunctionMemoryAttrsAnalysis());
@@ -185,8 +203,9 @@ void addAfterSROAAnalysis(const GlobalOptions &GO, const DataLayout &DL,
   Passes.add(createPOFunctionAttrsAnalysis());
   Passes.add(createPointerScalarizerPass());
   Passes.add(createMemoryMatcherPass());
-  Passes.add(createGlobalsAccessCollector());
   Passes.add(createCallExtractorPass());
+  Passes.add(createFunctionChangeTracker());
+  Passes.add(createGlobalsAccessCollector());
   Passes.add(createGlobalDefinedMemoryPass());
   Passes.add(createGlobalLiveMemoryPass());
   Passes.add(createFunctionMemoryAttrsAnalysis());
@@ -217,8 +236,9 @@ void addAfterLoopRotateAnalysis(legacy::PassManager &Passes) {
   Passes.add(createLoopSimplifyPass());
   Passes.add(createLCSSAPass());
   Passes.add(createMemoryMatcherPass());
-  Passes.add(createGlobalsAccessCollector());
   Passes.add(createCallExtractorPass());
+  Passes.add(createFunctionChangeTracker());
+  Passes.add(createGlobalsAccessCollector());
   Passes.add(createGlobalDefinedMemoryPass());
   Passes.add(createGlobalLiveMemoryPass());
   Passes.add(createFunctionMemoryAttrsAnalysis());
@@ -238,7 +258,7 @@ void DefaultQueryManager::addWithPrint(llvm::Pass *P, bool PrintResult,
   if (PrintResult) {
     auto PI = PassRegistry::getPassRegistry()->getPassInfo(P->getPassID());
     Passes.add(P);
-    Passes.add(createFunctionPassPrinter(PI, errs()));
+    Passes.add(createFunctionPassPrinter(PI, mPrintOS ? *mPrintOS : errs()));
     return;
   }
   Passes.add(P);
@@ -246,7 +266,7 @@ void DefaultQueryManager::addWithPrint(llvm::Pass *P, bool PrintResult,
 
 void DefaultQueryManager::run(llvm::Module *M, TransformationInfo *TfmInfo) {
   assert(M && "Module must not be null!");
-  auto &PrintOS{errs()};
+  auto &PrintOS{mPrintOS ? *mPrintOS : errs()};
   if (!mPrintPasses.empty() && mGlobalOptions->PrintToolVersion)
     printToolVersion(PrintOS);
   legacy::PassManager Passes;
@@ -333,6 +353,7 @@ void DefaultQueryManager::run(llvm::Module *M, TransformationInfo *TfmInfo) {
     return;
   }
   Passes.add(createMemoryMatcherPass());
+  Passes.add(createFunctionChangeStorage());
   Passes.add(createGlobalDefinedMemoryStorage());
   Passes.add(createGlobalLiveMemoryStorage());
   // It is necessary to destroy DIMemoryTraitPool before DIMemoryEnvironment to
@@ -24,6 +24,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "tsar/Core/AnalysisCache.h"
 #include "tsar/Core/IRAction.h"
 #include "tsar/Core/Query.h"
 #include "tsar/Core/Passes.h"
@@ -34,6 +35,7 @@
 #include "tsar/Frontend/Clang/Pragma.h"
 #include "tsar/Support/GlobalOptions.h"
 #include <clang/Frontend/FrontendActions.h>
+#include <clang/Frontend/TextDiagnosticPrinter.h>
 #include <clang/Tooling/CommonOptionsParser.h>
 #include <clang/Tooling/Tooling.h>
 #ifdef FLANG_FOUND
@@ -41,11 +43,16 @@
 # include "tsar/Frontend/Flang/Tooling.h"
 # include <flang/Frontend/FrontendOptions.h>
 #endif
+#include <llvm/ADT/DenseSet.h>
 #include <llvm/IR/LegacyPassNameParser.h>
 #include <llvm/Support/Debug.h>
 #include <llvm/Support/Path.h>
 #include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/TimeProfiler.h>
 #include <llvm/Support/CommandLine.h>
+#include <llvm/Support/VirtualFileSystem.h>
 
 using namespace clang;
 using namespace clang::tooling;
@@ -128,12 +135,14 @@ struct Options : private bcl::Uncopyable {
   llvm::cl::list<std::string> EnableWarnings;
   llvm::cl::opt<std::string> BuildPath;
   llvm::cl::alias BuildPathA;
+  llvm::cl::opt<unsigned> Jobs;
 
   llvm::cl::OptionCategory DebugCategory;
   llvm::cl::opt<bool> EmitLLVM;
   llvm::cl::opt<bool> PrintAST;
   llvm::cl::opt<bool> DumpAST;
   llvm::cl::opt<bool> TimeReport;
+  llvm::cl::opt<std::string> ProfilePasses;
   llvm::cl::opt<bool> UseServer;
 
   llvm::cl::opt<bool> PrintAll;
@@ -168,6 +177,7 @@ struct Options : private bcl::Uncopyable {
   llvm::cl::opt<bool> LoadSources;
   llvm::cl::opt<bool> NoLoadSources;
   llvm::cl::list<std::string> AnalysisUse;
+  llvm::cl::opt<std::string> AnalysisCacheDir;
   llvm::cl::opt<std::string> ProfileUse;
   llvm::cl::list<std::string> ObjectFilenames;
   llvm::cl::opt<unsigned> LoopParallelThreshold;
@@ -231,6 +241,9 @@ Options::Options() :
   BuildPath("build-path", cl::desc("Starting point to look up for compilation database in upward direction"),
     cl::cat(CompileCategory)),
   BuildPathA("p", cl::aliasopt(BuildPath), cl::desc("Alias for -build-path")),
+  Jobs("j", cl::cat(CompileCategory), cl::value_desc("N"), cl::init(1),
+    cl::Prefix, cl::desc("Analyze up to N translation units in parallel "
+                         "(0 means the number of available cores)")),
   DebugCategory("Debugging options"),
   EmitLLVM("emit-llvm", cl::cat(DebugCategory),
     cl::desc("Emit llvm without analysis")),
@@ -240,6 +253,10 @@ Options::Options() :
     cl::desc("Build ASTs and then debug dump them")),
   TimeReport("ftime-report", cl::cat(DebugCategory),
     cl::desc("Print some statistics about the time consumed by each pass when it finishes")),
+  ProfilePasses("profile-passes", cl::cat(DebugCategory),
+    cl::value_desc("filename"),
+    cl::desc("Write time trace of each pass execution and sizes of analysis "
+             "results to <filename> (in Chrome trace format)")),
   UseServer("use-analysis-server", cl::cat(DebugCategory),
     cl::desc("Run default workflow on analysis server")),
   PrintAll("print-all", cl::cat(DebugCategory),
@@ -316,6 +333,10 @@ Options::Options() :
   AnalysisUse("fanalysis-use", cl::cat(AnalysisCategory),
     cl::value_desc("filenames"), cl::ValueRequired, cl::CommaSeparated,
     cl::desc("Use external analysis results to clarify analysis")),
+  AnalysisCacheDir("fanalysis-cache", cl::cat(AnalysisCategory),
+    cl::value_desc("directory"),
+    cl::desc("Reuse results of analysis of unchanged translation units "
+             "stored in a specified directory")),
   ProfileUse("fprofile-use", cl::cat(AnalysisCategory),
     cl::value_desc("filename"),
     cl::desc("Use profile to clarify analysis")),
@@ -412,6 +433,26 @@ Tool::Tool(int Argc, const char **Argv) {
   auto Args = addInternalArgs(Argc, Argv);
   cl::ParseCommandLineOptions(Args.size(), Args.data(), Descr);
   storeCLOptions();
+  // Remember options which may affect results of analysis to distinguish
+  // cached results. Positions of options which do not affect results are
+  // taken from the parser, so values of these options are also ignored
+  // if they are separated from option names (for example, '-j 4').
+  SmallDenseSet<unsigned, 8> IgnoredArgs;
+  auto ignoreOption = [&Args, &IgnoredArgs](const cl::Option &Opt) {
+    if (Opt.getNumOccurrences() == 0)
+      return;
+    // The parser remembers position of a value if it is a separate argument.
+    auto Pos = Opt.getPosition();
+    IgnoredArgs.insert(Pos);
+    if (Pos > 1 && StringRef(Args[Pos - 1]).ltrim('-') == Opt.ArgStr)
+      IgnoredArgs.insert(Pos - 1);
+  };
+  ignoreOption(Options::get().Jobs);
+  ignoreOption(Options::get().AnalysisCacheDir);
+  ignoreOption(Options::get().ProfilePasses);
+  for (unsigned I = 1, EI = Args.size(); I < EI; ++I)
+    if (!IgnoredArgs.count(I) && !is_contained(mSources, Args[I]))
+      mToolOptions.emplace_back(Args[I]);
   InitializeAllTargetInfos();
   InitializeAllTargetMCs();
   InitializeAllAsmParsers();
@@ -657,6 +698,10 @@ void Tool::storeCLOptions() {
     exit(1);
   }
   mOutputFilename = Options::get().Output;
+  // Do not rely on a default value, -j must be explicitly specified.
+  mJobs = Options::get().Jobs.getNumOccurrences() > 0 ? Options::get().Jobs : 1;
+  mProfileFilename = Options::get().ProfilePasses;
+  mCacheDir = Options::get().AnalysisCacheDir;
   storePrintOptions(IncompatibleOpts);
   mLanguage = Options::get().Language;
   /// TODO (kaniandr@gmail.com): allow to use -output-suffix option for
@@ -699,7 +744,109 @@ void Tool::storeCLOptions() {
   }
 }
 
+int Tool::runInParallel(ArrayRef<std::string> Sources) {
+  struct WorkerResult {
+    std::string Output;
+    int Res = 0;
+  };
+  std::vector<WorkerResult> Results(Sources.size());
+  Optional<AnalysisCache> Cache;
+  // Options which are used to compute keys of cached results. Input files
+  // (external analysis results, profiles) are hashed once for all sources.
+  std::vector<std::string> KeyOptions{mToolOptions};
+  if (!mCacheDir.empty()) {
+    Cache.emplace(mCacheDir);
+    std::vector<std::string> InputFiles{mGlobalOpts.AnalysisUse};
+    if (!mGlobalOpts.ProfileUse.empty())
+      InputFiles.push_back(mGlobalOpts.ProfileUse);
+    InputFiles.insert(InputFiles.end(), mGlobalOpts.ObjectFilenames.begin(),
+                      mGlobalOpts.ObjectFilenames.end());
+    KeyOptions.push_back(AnalysisCache::hashFiles(InputFiles));
+  }
+  ThreadPool Pool(hardware_concurrency(mJobs));
+  for (std::size_t I = 0, EI = Sources.size(); I < EI; ++I)
+    Pool.async([this, &Sources, &Results, &Cache, &KeyOptions, I]() {
+      Optional<std::string> Key;
+      if (Cache) {
+        Key = AnalysisCache::computeKey(*mCompilations, Sources[I],
+                                        KeyOptions);
+        if (Key)
+          if (auto Entry{Cache->lookup(*Key)}) {
+            Results[I].Output = std::move(Entry->Output);
+            Results[I].Res = Entry->Result;
+            return;
+          }
+      }
+      // Time trace profiler collects events for each thread separately.
+      if (!mProfileFilename.empty())
+        timeTraceProfilerInitialize(0, mToolName);
+      raw_string_ostream OS(Results[I].Output);
+      DefaultQueryManager QM(false, &mGlobalOpts, mOutputPasses, mPrintPasses,
+                             (DefaultQueryManager::ProcessingStep)mPrintSteps);
+      QM.setPrintStream(OS);
+      IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts{new DiagnosticOptions};
+      TextDiagnosticPrinter DiagPrinter(OS, DiagOpts.get());
+      // Clang tool changes working directory in accordance with a compilation
+      // database, so a separate physical file system (with its own working
+      // directory) is necessary for each worker.
+      ClangTool CTool(*mCompilations, Sources[I],
+                      std::make_shared<PCHContainerOperations>(),
+                      vfs::createPhysicalFileSystem());
+      CTool.setDiagnosticConsumer(&DiagPrinter);
+      {
+        TimeTraceScope SourceScope("Source", Sources[I]);
+        Results[I].Res = CTool.run(
+            newClangActionFactory<ClangMainAction, GenPCHPragmaAction>(
+                std::forward_as_tuple(*mCompilations, QM))
+                .get());
+      }
+      OS.flush();
+      if (!mProfileFilename.empty())
+        timeTraceProfilerFinishThread();
+      // Do not cache failures, they may depend on the environment.
+      if (Key && Results[I].Res == 0)
+        if (auto E{Cache->store(*Key, {Results[I].Res, Results[I].Output})})
+          Results[I].Output += "warning: unable to store analysis results "
+                               "in cache: " + toString(std::move(E)) + "\n";
+    });
+  Pool.wait();
+  bool ProcessingFailed{false}, FileSkipped{false};
+  for (auto &R : Results) {
+    errs() << R.Output;
+    ProcessingFailed |= R.Res == 1;
+    FileSkipped |= R.Res == 2;
+  }
+  return ProcessingFailed ? 1 : FileSkipped ? 2 : 0;
+}
+
+namespace {
+/// This initializes time trace profiler if it is necessary and writes
+/// collected events to a specified file on destruction.
+class TimeTraceProfilerRAII {
+public:
+  TimeTraceProfilerRAII(StringRef Filename, StringRef ProcName)
+      : mFilename(Filename) {
+    if (!mFilename.empty())
+      timeTraceProfilerInitialize(0, ProcName);
+  }
+
+  ~TimeTraceProfilerRAII() {
+    if (mFilename.empty())
+      return;
+    if (auto E = timeTraceProfilerWrite(mFilename, mFilename))
+      errs() << "error: unable to write time trace profile: "
+             << toString(std::move(E)) << "\n";
+    timeTraceProfilerCleanup();
+  }
+
+private:
+  StringRef mFilename;
+};
+}
+
 int Tool::run(QueryManager *QM) {
+  // Events for each pass invocation are added by the pass manager.
+  TimeTraceProfilerRAII Profiler(mProfileFilename, mToolName);
   std::vector<std::string> NoASTCSources;
   std::vector<std::string> CSourcesToMerge;
   std::vector<std::string> LLSources;
@@ -792,6 +939,21 @@ int Tool::run(QueryManager *QM) {
     EmitPCHTool.run(
         newClangActionFactory<GeneratePCHAction, GenPCHPragmaAction>().get());
   }
+  // Only default analysis (without analysis server) of separate translation
+  // units can be performed in parallel or reuse cached results. Output passes
+  // may produce files which are not stored in cache, and these files are not
+  // protected against concurrent writes.
+  bool IsSeparate{!QM && !mMergeAST && !mDumpAST && !mPrintAST && !mEmitLLVM &&
+                  !mInstrLLVM && !mTfmPass && !mCheck && !mServer &&
+                  mOutputPasses.empty()};
+  bool IsParallel{IsSeparate && mJobs != 1 && CSources.size() > 1};
+  if (mJobs > 1 && !IsParallel)
+    errs() << "WARNING: The -j option is ignored for the specified "
+              "combination of options and inputs.\n";
+  bool UseCache{IsSeparate && !mCacheDir.empty()};
+  if (!mCacheDir.empty() && !UseCache)
+    errs() << "WARNING: The -fanalysis-cache option is ignored for the "
+              "specified combination of options.\n";
   if (!QM) {
     if (mEmitLLVM)
       QM = getEmitLLVMQM();
@@ -840,10 +1002,12 @@ int Tool::run(QueryManager *QM) {
     return CTool.run(
         newClangActionFactory<tsar::ASTPrintAction, tsar::GenPCHPragmaAction>()
             .get());
-  auto CRes{
-      CTool.run(newClangActionFactory<ClangMainAction, GenPCHPragmaAction>(
-                    std::forward_as_tuple(*mCompilations, *QM))
-                    .get())};
+  auto CRes{IsParallel || UseCache ? runInParallel(CSources)
+                       : CTool.run(newClangActionFactory<ClangMainAction,
+                                                         GenPCHPragmaAction>(
+                                       std::forward_as_tuple(*mCompilations,
+                                                             *QM))
+                                       .get())};
   int FortranRes{0};
 #ifdef FLANG_FOUND
   FlangTool FortranTool(*mCompilations, FortranSources);
@@ -27,10 +27,13 @@
 #include "tsar/Support/MetadataUtils.h"
 #include "tsar/Support/OutputFile.h"
 #include <llvm/IR/DIBuilder.h>
+#include <llvm/IR/Instructions.h>
 #include <llvm/IR/IntrinsicInst.h>
 #include <llvm/IR/Operator.h>
 #include <llvm/Support/Errc.h>
 #include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/TimeProfiler.h>
 #include <llvm/Support/raw_ostream.h>
 #include <regex>
 
@@ -38,6 +41,30 @@ using namespace llvm;
 using namespace tsar;
 
 namespace tsar {
+TimeTraceSizes::TimeTraceSizes(StringRef Name, const Function &F) {
+  if (!timeTraceProfilerEnabled())
+    return;
+  mIsEnabled = true;
+  mName = Name.str();
+  mFunction = F.getName().str();
+  mMallocUsage = sys::Process::GetMallocUsage();
+}
+
+TimeTraceSizes::~TimeTraceSizes() {
+  if (!mIsEnabled)
+    return;
+  std::string Detail;
+  raw_string_ostream OS(Detail);
+  OS << mFunction;
+  for (auto &[What, Size] : mSizes)
+    OS << ", " << What << ": " << Size;
+  OS << ", malloc delta: "
+     << static_cast<int64_t>(sys::Process::GetMallocUsage()) -
+            static_cast<int64_t>(mMallocUsage);
+  timeTraceProfilerBegin(mName, OS.str());
+  timeTraceProfilerEnd();
+}
+
 std::vector<StringRef> tokenize(StringRef Str, StringRef Pattern) {
   std::vector<StringRef> Tokens;
   std::regex Rgx(Pattern.data());
@@ -97,6 +124,101 @@ llvm::Argument * getArgument(llvm::Function &F, std::size_t ArgNo) {
   return ArgItr != ArgItrE ? &*ArgItr : nullptr;
 }
 
+/// Compute hash of an instruction state which is not stored in operands.
+///
+/// This is similar to FunctionComparator::cmpOperations(), values of operands
+/// are not taken into account.
+static hash_code hashOperation(const Instruction &I) {
+  auto Hash = hash_combine(I.getOpcode(), I.getType(),
+                           I.getRawSubclassOptionalData(), I.getNumOperands());
+  if (auto *Cmp = dyn_cast<CmpInst>(&I))
+    return hash_combine(Hash, Cmp->getPredicate());
+  if (auto *AI = dyn_cast<AllocaInst>(&I))
+    return hash_combine(Hash, AI->getAllocatedType(), AI->getAlign().value());
+  if (auto *GEP = dyn_cast<GetElementPtrInst>(&I))
+    return hash_combine(Hash, GEP->getSourceElementType());
+  if (auto *LI = dyn_cast<LoadInst>(&I))
+    return hash_combine(Hash, LI->isVolatile(), LI->getAlign().value(),
+                        LI->getOrdering(), LI->getSyncScopeID());
+  if (auto *SI = dyn_cast<StoreInst>(&I))
+    return hash_combine(Hash, SI->isVolatile(), SI->getAlign().value(),
+                        SI->getOrdering(), SI->getSyncScopeID());
+  if (auto *Call = dyn_cast<CallBase>(&I)) {
+    Hash = hash_combine(Hash, Call->getAttributes().getRawPointer(),
+                        Call->getCallingConv(), Call->getFunctionType(),
+                        Call->getNumOperandBundles());
+    if (auto *CI = dyn_cast<CallInst>(&I))
+      Hash = hash_combine(Hash, CI->getTailCallKind());
+    for (unsigned Idx = 0, EIdx = Call->getNumOperandBundles(); Idx < EIdx;
+         ++Idx) {
+      auto Bundle = Call->getOperandBundleAt(Idx);
+      Hash = hash_combine(Hash, Bundle.getTagID(), Bundle.Inputs.size());
+    }
+    return Hash;
+  }
+  if (auto *EV = dyn_cast<ExtractValueInst>(&I))
+    return hash_combine(Hash, hash_combine_range(EV->idx_begin(),
+                                                 EV->idx_end()));
+  if (auto *IV = dyn_cast<InsertValueInst>(&I))
+    return hash_combine(Hash, hash_combine_range(IV->idx_begin(),
+                                                 IV->idx_end()));
+  if (auto *SV = dyn_cast<ShuffleVectorInst>(&I))
+    return hash_combine(Hash, hash_combine_range(SV->getShuffleMask().begin(),
+                                                 SV->getShuffleMask().end()));
+  if (auto *FI = dyn_cast<FenceInst>(&I))
+    return hash_combine(Hash, FI->getOrdering(), FI->getSyncScopeID());
+  if (auto *CXI = dyn_cast<AtomicCmpXchgInst>(&I))
+    return hash_combine(Hash, CXI->isVolatile(), CXI->isWeak(),
+                        CXI->getAlign().value(), CXI->getSuccessOrdering(),
+                        CXI->getFailureOrdering(), CXI->getSyncScopeID());
+  if (auto *RMW = dyn_cast<AtomicRMWInst>(&I))
+    return hash_combine(Hash, RMW->getOperation(), RMW->isVolatile(),
+                        RMW->getAlign().value(), RMW->getOrdering(),
+                        RMW->getSyncScopeID());
+  if (auto *LP = dyn_cast<LandingPadInst>(&I))
+    return hash_combine(Hash, LP->isCleanup());
+  return Hash;
+}
+
+hash_code hashFunction(const Function &F) {
+  // Local values are identified by their numbers in the function.
+  DenseMap<const Value *, unsigned> Numbers;
+  for (auto &Arg : F.args())
+    Numbers.try_emplace(&Arg, Numbers.size());
+  for (auto &BB : F) {
+    Numbers.try_emplace(&BB, Numbers.size());
+    for (auto &I : BB)
+      Numbers.try_emplace(&I, Numbers.size());
+  }
+  auto hashOperand = [&Numbers](const Value *V) {
+    auto I = Numbers.find(V);
+    return I != Numbers.end() ? hash_combine(true, I->second)
+                              : hash_combine(false, V);
+  };
+  auto Hash = hash_combine(F.getFunctionType(), F.getLinkage(),
+                           F.getCallingConv(),
+                           F.getAttributes().getRawPointer(),
+                           F.getSubprogram(), F.size(),
+                           F.hasPersonalityFn() ? F.getPersonalityFn()
+                                                : nullptr);
+  SmallVector<std::pair<unsigned, MDNode *>, 8> MDs;
+  for (auto &BB : F) {
+    Hash = hash_combine(Hash, BB.size());
+    for (auto &I : BB) {
+      Hash = hash_combine(Hash, hashOperation(I));
+      for (auto &Op : I.operands())
+        Hash = hash_combine(Hash, hashOperand(Op));
+      if (auto *PN = dyn_cast<PHINode>(&I))
+        for (auto *Incoming : PN->blocks())
+          Hash = hash_combine(Hash, hashOperand(Incoming));
+      I.getAllMetadata(MDs);
+      for (auto &MD : MDs)
+        Hash = hash_combine(Hash, MD.first, MD.second);
+    }
+  }
+  return Hash;
+}
+
 bool pointsToLocalMemory(const Value &V, const Loop &L) {
   if (!isa<AllocaInst>(V))
     return false;
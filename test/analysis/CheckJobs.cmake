@@ -0,0 +1,20 @@
+# Run TSAR on a SOURCE file with a list of OPTIONS twice: sequentially and with
+# a specified number of threads (-private-jobs=JOBS). Check that both runs
+# print the same results.
+foreach(J 1 ${JOBS})
+  execute_process(
+    COMMAND ${TSAR} ${SOURCE} ${OPTIONS} -private-jobs=${J}
+    RESULT_VARIABLE Result
+    OUTPUT_VARIABLE Output${J}
+    ERROR_VARIABLE Error)
+  if(NOT Result EQUAL 0)
+    message(FATAL_ERROR "TSAR fails with -private-jobs=${J}:\n${Error}")
+  endif()
+endforeach()
+if("${Output1}" STREQUAL "")
+  message(FATAL_ERROR "TSAR does not print analysis results")
+endif()
+if(NOT "${Output1}" STREQUAL "${Output${JOBS}}")
+  message(FATAL_ERROR "Results differ for -private-jobs=1 and "
+    "-private-jobs=${JOBS}:\n${Output1}\n${Output${JOBS}}")
+endif()
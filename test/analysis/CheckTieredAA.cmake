@@ -0,0 +1,34 @@
+# Run TSAR on a SOURCE file and print dependence analysis results for the
+# FIRST and the LAST processing steps. Check that aliasing produces output
+# dependencies at the first step and at the last step without -use-tiered-aa,
+# but these dependencies disappear at the last step with -use-tiered-aa.
+function(run_tsar STEP VAR)
+  execute_process(
+    COMMAND ${TSAR} ${SOURCE} -print-only=da-di -print-step=${STEP} ${ARGN}
+    RESULT_VARIABLE Result
+    OUTPUT_VARIABLE Output
+    ERROR_VARIABLE Error)
+  if(NOT Result EQUAL 0)
+    message(FATAL_ERROR "TSAR fails at step ${STEP} ${ARGN}:\n${Error}")
+  endif()
+  if("${Output}" STREQUAL "")
+    message(FATAL_ERROR "TSAR does not print analysis results")
+  endif()
+  set(${VAR} "${Output}" PARENT_SCOPE)
+endfunction()
+
+run_tsar(${FIRST} FirstTiered -use-tiered-aa)
+run_tsar(${LAST} Last)
+run_tsar(${LAST} LastTiered -use-tiered-aa)
+if(NOT "${FirstTiered}" MATCHES "output:")
+  message(FATAL_ERROR "Loop is not rejected at step ${FIRST} with "
+    "-use-tiered-aa:\n${FirstTiered}")
+endif()
+if(NOT "${Last}" MATCHES "output:")
+  message(FATAL_ERROR "Loop is not rejected at step ${LAST} without "
+    "-use-tiered-aa:\n${Last}")
+endif()
+if("${LastTiered}" MATCHES "output:")
+  message(FATAL_ERROR "Loop is rejected at step ${LAST} with "
+    "-use-tiered-aa:\n${LastTiered}")
+endif()
@@ -0,0 +1,120 @@
+//===- FunctionChanges.cpp --- Function Change Test -------------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This test checks that a function is considered as modified if its body has
+// been rebuilt, even if the new body has the same hash. Interprocedural
+// analysis (GlobalDefinedMemory, GlobalLiveMemory, etc.) reuses summaries of
+// functions which are not affected by modifications, so summaries of the
+// rebuilt function and its callers must be recomputed.
+//
+//===----------------------------------------------------------------------===//
+
+#include <tsar/Analysis/FunctionChanges.h>
+#include <tsar/Support/IRUtils.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/Analysis/CallGraph.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
+
+using namespace llvm;
+using namespace tsar;
+
+/// Build a body of a function which increments a specified global variable.
+void buildBody(Function &F, GlobalVariable &GV) {
+  auto &Ctx = F.getContext();
+  IRBuilder<> Builder(BasicBlock::Create(Ctx, "entry", &F));
+  auto *Val = Builder.CreateLoad(GV.getValueType(), &GV);
+  Builder.CreateStore(Builder.CreateAdd(Val, Builder.getInt32(1)), &GV);
+  Builder.CreateRetVoid();
+}
+
+bool check(bool Condition, const Twine &Msg) {
+  if (!Condition)
+    errs() << "error: " << Msg << "\n";
+  return Condition;
+}
+
+/// Recompute changes and check which functions are modified and affected.
+bool update(FunctionChangeInfo &Changes, Module &M, const Twine &Step,
+    ArrayRef<const Function *> Modified, ArrayRef<const Function *> Affected) {
+  CallGraph CG(M);
+  Changes.update(M, CG);
+  bool IsOk = true;
+  for (auto &F : M) {
+    IsOk &= check(Changes.isModified(F) == is_contained(Modified, &F),
+      Step + ": function '" + F.getName() + "' must" +
+      (is_contained(Modified, &F) ? "" : " not") + " be modified");
+    IsOk &= check(Changes.isAffected(F) == is_contained(Affected, &F),
+      Step + ": function '" + F.getName() + "' must" +
+      (is_contained(Affected, &F) ? "" : " not") + " be affected");
+  }
+  return IsOk;
+}
+
+int main() {
+  LLVMContext Ctx;
+  Module M("function-changes", Ctx);
+  auto *Int32Ty = Type::getInt32Ty(Ctx);
+  auto *GV = new GlobalVariable(M, Int32Ty, false,
+    GlobalValue::InternalLinkage, Constant::getNullValue(Int32Ty), "g");
+  auto *FTy = FunctionType::get(Type::getVoidTy(Ctx), false);
+  auto *Callee =
+    Function::Create(FTy, GlobalValue::ExternalLinkage, "callee", M);
+  buildBody(*Callee, *GV);
+  auto *Caller =
+    Function::Create(FTy, GlobalValue::ExternalLinkage, "caller", M);
+  IRBuilder<> Builder(BasicBlock::Create(Ctx, "entry", Caller));
+  Builder.CreateCall(Callee);
+  Builder.CreateRetVoid();
+  auto *Other = Function::Create(FTy, GlobalValue::ExternalLinkage, "other", M);
+  buildBody(*Other, *GV);
+  FunctionChangeInfo Changes;
+  bool IsOk = update(Changes, M, "initial update", {Callee, Caller, Other},
+    {Callee, Caller, Other});
+  IsOk &= update(Changes, M, "update without modifications", {}, {});
+  // Rebuild the body and keep the previous one alive, so new instructions
+  // have different addresses.
+  auto Hash = hashFunction(*Callee);
+  auto *Holder = Function::Create(FTy, GlobalValue::InternalLinkage,
+    "holder", M);
+  for (auto &BB : make_early_inc_range(*Callee)) {
+    BB.removeFromParent();
+    BB.insertInto(Holder);
+  }
+  buildBody(*Callee, *GV);
+  IsOk &= check(Hash == hashFunction(*Callee),
+    "hash of the rebuilt function must not change");
+  IsOk &= update(Changes, M, "update after rebuild", {Callee, Holder},
+    {Callee, Caller, Holder});
+  // Rebuild the body after the previous one has been deleted, so new
+  // instructions may reuse addresses of deleted ones.
+  Holder->eraseFromParent();
+  Callee->deleteBody();
+  buildBody(*Callee, *GV);
+  IsOk &= check(Hash == hashFunction(*Callee),
+    "hash of the rebuilt function must not change");
+  IsOk &= update(Changes, M, "update after deletion and rebuild", {Callee},
+    {Callee, Caller});
+  IsOk &= check(Changes.deleted().size() == 1,
+    "deleted function must be reported");
+  return IsOk ? 0 : 1;
+}
@@ -0,0 +1,32 @@
+//===--- PrivateJobs.c ------ Independent Loop Nests --------------*- C -*-===//
+//
+// This file contains independent loop nests with different traits of
+// memory locations. Results of private variable analysis must not depend on
+// the number of threads which are used to analyze loop nests (-private-jobs).
+//
+//===----------------------------------------------------------------------===//
+
+#define N 100
+
+double A[N], B[N], C[N][N];
+
+double foo() {
+  double T, S = 0;
+  for (int I = 0; I < N; ++I) {
+    T = A[I];
+    B[I] = T * T;
+  }
+  for (int I = 0; I < N; ++I)
+    S += A[I];
+  for (int I = 1; I < N; ++I)
+    for (int J = 0; J < N; ++J)
+      C[I][J] = C[I - 1][J] + B[J];
+  for (int I = 0; I < N - 1; ++I)
+    A[I] = A[I + 1];
+  for (int I = 0; I < N; ++I) {
+    T = C[I][I];
+    for (int J = 0; J < N; ++J)
+      C[I][J] = T + J;
+  }
+  return S;
+}
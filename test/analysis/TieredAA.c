@@ -0,0 +1,21 @@
+//===--- TieredAA.c -------- Escalation of Alias Analysis ---------*- C -*-===//
+//
+// This file contains a loop which accesses memory through pointers returned
+// from a function call. Basic alias analysis does not look through the call,
+// so aliasing prevents parallelization of the loop at the first processing
+// step. With -use-tiered-aa Andersen's alias analysis is used for 'foo' at the
+// subsequent steps and the loop has no output dependencies any more.
+//
+//===----------------------------------------------------------------------===//
+
+#define N 100
+
+double X[N], Y[N];
+
+static __attribute__((noinline)) double *id(double *P) { return P; }
+
+void foo() {
+  double *A = id(X), *B = id(Y);
+  for (int I = 0; I < N; ++I)
+    A[I] = B[I];
+}
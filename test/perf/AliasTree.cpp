@@ -0,0 +1,152 @@
+//===--- AliasTree.cpp ------- Alias Tree Benchmark -------------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This benchmark builds alias trees for synthetic functions which access
+// a large number of memory locations. It compares allocation of tree nodes and
+// estimate memory locations in arenas with individual heap allocation.
+//
+//===----------------------------------------------------------------------===//
+
+#include <tsar/Core/tsar-config.h>
+#include <tsar/Analysis/Memory/EstimateMemory.h>
+#include <llvm/Analysis/AssumptionCache.h>
+#include <llvm/Analysis/BasicAliasAnalysis.h>
+#include <llvm/Analysis/TargetLibraryInfo.h>
+#include <llvm/IR/Dominators.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <tuple>
+
+using namespace llvm;
+using namespace tsar;
+
+/// Build a function which accesses `Size` different memory locations.
+///
+/// Locations are elements of `Arrays` global arrays, so the alias tree
+/// contains both separate nodes for different arrays and hierarchies of
+/// locations with the same base.
+Function * buildFunction(Module &M, std::size_t Size, std::size_t Arrays) {
+  auto &Ctx = M.getContext();
+  auto *Int32Ty = Type::getInt32Ty(Ctx);
+  auto ElementsNum = (Size + Arrays - 1) / Arrays;
+  auto *ArrayTy = ArrayType::get(Int32Ty, ElementsNum);
+  auto *F = Function::Create(FunctionType::get(Type::getVoidTy(Ctx), false),
+    GlobalValue::ExternalLinkage, "kernel", M);
+  IRBuilder<> Builder(BasicBlock::Create(Ctx, "entry", F));
+  for (std::size_t A = 0; A < Arrays && Size > 0; ++A) {
+    auto *GV = new GlobalVariable(M, ArrayTy, false,
+      GlobalValue::InternalLinkage, Constant::getNullValue(ArrayTy));
+    for (std::size_t I = 0; I < ElementsNum && Size > 0; ++I, --Size) {
+      auto *Ptr = Builder.CreateConstInBoundsGEP2_64(ArrayTy, GV, 0, I);
+      auto *Val = Builder.CreateLoad(Int32Ty, Ptr);
+      Builder.CreateStore(Builder.CreateAdd(Val, Builder.getInt32(1)), Ptr);
+    }
+  }
+  Builder.CreateRetVoid();
+  return F;
+}
+
+/// Build and destroy alias tree for a specified function `MaxIter` times,
+/// return average time of build and destroy and the number of alias nodes.
+std::tuple<std::chrono::duration<double>, std::chrono::duration<double>,
+           std::size_t>
+build(Function &F, bool UseArena, unsigned MaxIter) {
+  auto &DL = F.getParent()->getDataLayout();
+  TargetLibraryInfoImpl TLII(Triple(F.getParent()->getTargetTriple()));
+  TargetLibraryInfo TLI(TLII);
+  AssumptionCache AC(F);
+  DominatorTree DT(F);
+  std::chrono::duration<double> Build(0), Destroy(0);
+  std::size_t Nodes = 0;
+  for (unsigned Iter = 0; Iter < MaxIter; ++Iter) {
+    BasicAAResult BAR(DL, F, TLI, AC, &DT);
+    AAResults AA(TLI);
+    AA.addAAResult(BAR);
+    auto StartTime = std::chrono::high_resolution_clock::now();
+    auto AT = std::make_unique<AliasTree>(AA, DL, DT, UseArena);
+    for (auto &I : instructions(F))
+      if (auto *SI = dyn_cast<StoreInst>(&I))
+        AT->add(MemoryLocation::get(SI));
+    Build += std::chrono::high_resolution_clock::now() - StartTime;
+    Nodes = AT->size();
+    StartTime = std::chrono::high_resolution_clock::now();
+    AT.reset();
+    Destroy += std::chrono::high_resolution_clock::now() - StartTime;
+  }
+  return std::make_tuple(Build / MaxIter, Destroy / MaxIter, Nodes);
+}
+
+void run(std::size_t Size, std::size_t Arrays, unsigned MaxIter) {
+  LLVMContext Ctx;
+  Module M("alias-tree-perf", Ctx);
+  auto *F = buildFunction(M, Size, Arrays);
+  auto [HeapBuild, HeapDestroy, HeapNodes] = build(*F, false, MaxIter);
+  auto [ArenaBuild, ArenaDestroy, ArenaNodes] = build(*F, true, MaxIter);
+  assert(HeapNodes == ArenaNodes && "Alias trees must be the same!");
+  (void)HeapNodes;
+  outs() << "  number of memory locations " << Size << "\n";
+  outs() << "  number of alias nodes " << ArenaNodes << "\n";
+  outs() << "\n";
+  outs() << "  heap: alias tree build time (.s) " << HeapBuild.count() << "\n";
+  outs() << "  heap: alias tree destroy time (.s) " << HeapDestroy.count()
+    << "\n";
+  outs() << "  arena: alias tree build time (.s) " << ArenaBuild.count()
+    << "\n";
+  outs() << "  arena: alias tree destroy time (.s) " << ArenaDestroy.count()
+    << "\n";
+  outs() << "\n";
+  outs() << "  build speedup " << HeapBuild / ArenaBuild << "\n";
+  outs() << "  destroy speedup " << HeapDestroy / ArenaDestroy << "\n";
+  outs() << "  total speedup "
+    << (HeapBuild + HeapDestroy) / (ArenaBuild + ArenaDestroy) << "\n";
+}
+
+int main(int Argc, const char **Argv) {
+  std::string Help =
+    "parameter: [number of memory locations] [number of arrays] "
+    "[number of iterations]\n";
+  if (Argc > 4) {
+    errs() << "error: too many arguments\n" << Help;
+    return 1;
+  }
+  std::size_t Size = (Argc > 1) ? std::atoll(Argv[1]) : 10000;
+  std::size_t Arrays = (Argc > 2) ? std::atoll(Argv[2]) : 100;
+  unsigned MaxIter = (Argc > 3) ? std::atoi(Argv[3]) : 10;
+  if (Size == 0) {
+    errs() << "error: invalid number of memory locations\n" << Help;
+    return 2;
+  }
+  if (Arrays == 0) {
+    errs() << "error: invalid number of arrays\n" << Help;
+    return 3;
+  }
+  if (MaxIter == 0) {
+    errs() << "error: invalid number of iterations\n" << Help;
+    return 4;
+  }
+  run(Size, Arrays, MaxIter);
+  return 0;
+}
@@ -0,0 +1,163 @@
+//===- AnalysisSocket.cpp --- Analysis Socket Benchmark ---------*- C++ -*-===//
+//
+//                       Traits Static Analyzer (SAPFOR)
+//
+// Copyright 2022 DVM System Group
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This benchmark measures latency of requests to analysis server. It compares
+// typed requests which pass an address of a request through a socket with
+// requests which are encoded as JSON strings (-analysis-socket-json).
+//
+//===----------------------------------------------------------------------===//
+
+#include <tsar/Core/tsar-config.h>
+#include <tsar/Analysis/AnalysisSocket.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/raw_ostream.h>
+#include <chrono>
+#include <cstdlib>
+
+using namespace llvm;
+using namespace tsar;
+
+namespace {
+/// Stub of analysis which is available on a server.
+template<unsigned Idx> struct AnalysisStab {
+  static char ID;
+};
+template<unsigned Idx> char AnalysisStab<Idx>::ID = 0;
+
+using Analysis0 = AnalysisStab<0>;
+using Analysis1 = AnalysisStab<1>;
+using Analysis2 = AnalysisStab<2>;
+
+/// Emulate analysis server which is run in the same process.
+///
+/// The server does not depend on a function and returns results of
+/// `Analysis0`, `Analysis1` and `Analysis2` for any request.
+class ServerStab {
+public:
+  explicit ServerStab(AnalysisSocket &Socket) : mSocket(Socket) {
+    Socket.receive([this](const std::string &Request) { answer(Request); });
+  }
+
+  /// Return true if results of a specified analysis are correct.
+  template<class AnalysisType> bool check(const AnalysisType *A) const {
+    return A == static_cast<void *>(&mAnalysis[lookup(&AnalysisType::ID)]);
+  }
+
+private:
+  /// Return index of analysis with a specified ID.
+  static unsigned lookup(AnalysisID ID) {
+    if (ID == &Analysis0::ID)
+      return 0;
+    if (ID == &Analysis1::ID)
+      return 1;
+    assert(ID == &Analysis2::ID && "Unknown analysis!");
+    return 2;
+  }
+
+  void answer(StringRef Request) {
+    if (!Request.empty() && Request.back() == AnalysisSocket::Delimiter)
+      Request = Request.drop_back();
+    if (auto *Msg = AnalysisSocket::decodeMessage(Request)) {
+      for (std::size_t I = 0, EI = Msg->IDs.size(); I < EI; ++I)
+        Msg->Analysis[I] = &mAnalysis[lookup(Msg->IDs[I])];
+      Msg->IsFound = true;
+      mSocket.send(
+          std::string{AnalysisSocket::Data, AnalysisSocket::Delimiter});
+      return;
+    }
+    ::json::Parser<AnalysisRequest> Parser(Request.str());
+    AnalysisRequest R;
+    if (!Parser.parse(R)) {
+      mSocket.send(
+          std::string{AnalysisSocket::Invalid, AnalysisSocket::Delimiter});
+      return;
+    }
+    AnalysisResponse Response;
+    for (auto ID : R[AnalysisRequest::AnalysisIDs])
+      Response[AnalysisResponse::Analysis].push_back(&mAnalysis[lookup(ID)]);
+    mSocket.send(AnalysisSocket::Data +
+                 ::json::Parser<AnalysisResponse>::unparseAsObject(Response) +
+                 AnalysisSocket::Delimiter);
+  }
+
+  AnalysisSocket &mSocket;
+  char mAnalysis[3];
+};
+
+/// Enable or disable encoding of requests as JSON strings.
+void setJSONEnabled(bool IsEnabled) {
+  auto &Opts = cl::getRegisteredOptions();
+  auto Itr = Opts.find("analysis-socket-json");
+  assert(Itr != Opts.end() && "Option must be registered!");
+  *static_cast<cl::opt<bool> *>(Itr->second) = IsEnabled;
+}
+
+/// Perform `MaxIter` requests to a server, return average latency of
+/// a request or None if some of responses are incorrect.
+Optional<std::chrono::duration<double>> measure(Function &F, bool IsJSON,
+                                                unsigned MaxIter) {
+  setJSONEnabled(IsJSON);
+  AnalysisSocket Socket;
+  ServerStab Server(Socket);
+  bool IsCorrect = true;
+  auto StartTime = std::chrono::high_resolution_clock::now();
+  for (unsigned Iter = 0; Iter < MaxIter; ++Iter) {
+    auto R = Socket.getAnalysis<Analysis0, Analysis1, Analysis2>(F);
+    IsCorrect &= R && Server.check(R->value<Analysis0 *>()) &&
+                 Server.check(R->value<Analysis1 *>()) &&
+                 Server.check(R->value<Analysis2 *>());
+  }
+  std::chrono::duration<double> Time =
+      std::chrono::high_resolution_clock::now() - StartTime;
+  if (!IsCorrect)
+    return None;
+  return Time / MaxIter;
+}
+}
+
+int main(int Argc, const char **Argv) {
+  std::string Help = "parameter: [number of requests]\n";
+  if (Argc > 2) {
+    errs() << "error: too many arguments\n" << Help;
+    return 1;
+  }
+  unsigned MaxIter = (Argc > 1) ? std::atoi(Argv[1]) : 100000;
+  if (MaxIter == 0) {
+    errs() << "error: invalid number of requests\n" << Help;
+    return 2;
+  }
+  LLVMContext Ctx;
+  Module M("analysis-socket-perf", Ctx);
+  auto *F = Function::Create(FunctionType::get(Type::getVoidTy(Ctx), false),
+    GlobalValue::ExternalLinkage, "kernel", M);
+  auto JSON = measure(*F, true, MaxIter);
+  auto Typed = measure(*F, false, MaxIter);
+  if (!JSON || !Typed) {
+    errs() << "error: incorrect response from server\n";
+    return 3;
+  }
+  outs() << "  number of requests " << MaxIter << "\n";
+  outs() << "  JSON request latency (.s) " << JSON->count() << "\n";
+  outs() << "  typed request latency (.s) " << Typed->count() << "\n";
+  outs() << "  request speedup " << *JSON / *Typed << "\n";
+  return 0;
+}
@@ -37,6 +37,7 @@
 #include <llvm/ADT/Optional.h>
 #include <llvm/Support/FileSystem.h>
 #include <array>
+#include <functional>
 #include <limits>
 #include <vector>
 #include <string>
@@ -159,6 +160,45 @@ JSON_OBJECT_PAIR_6(Location,
   Location(Location &&) = default;
   Location & operator=(Location &&) = default;
 JSON_OBJECT_END(Location)
+
+/// \brief Sequence of objects which are generated on demand.
+///
+/// Objects are generated one by one when a message is serialized, so it is
+/// not necessary to keep all objects in memory at the same time. Parsed
+/// objects are stored in a list of items.
+template<class T> class LazySequence {
+public:
+  /// Generator constructs the next object, it returns false if there are
+  /// no more objects.
+  using GeneratorT = std::function<bool(T &)>;
+
+  LazySequence() = default;
+  explicit LazySequence(GeneratorT G) : mGenerator(std::move(G)) {}
+
+  /// Set generator of objects which are visited after stored items.
+  void setGenerator(GeneratorT G) { mGenerator = std::move(G); }
+
+  /// Return list of parsed or explicitly inserted objects.
+  std::vector<T> & items() noexcept { return mItems; }
+  const std::vector<T> & items() const noexcept { return mItems; }
+
+  /// Visit stored items and then generated objects.
+  template<class FunctionT> void for_each(FunctionT &&F) const {
+    for (auto &I : mItems)
+      F(I);
+    if (!mGenerator)
+      return;
+    T I;
+    while (mGenerator(I)) {
+      F(static_cast<const T &>(I));
+      I = T();
+    }
+  }
+
+private:
+  std::vector<T> mItems;
+  GeneratorT mGenerator;
+};
 }
 }
 
@@ -256,6 +296,26 @@ template<class T> struct Traits<llvm::Optional<T>> {
   }
 };
 
+/// Specialization of JSON serialization traits for tsar::msg::LazySequence.
+///
+/// Each object is unparsed straight after it has been generated.
+template<class T> struct Traits<tsar::msg::LazySequence<T>> {
+  static bool parse(tsar::msg::LazySequence<T> &Dest, Lexer &Lex) {
+    return Traits<std::vector<T>>::parse(Dest.items(), Lex);
+  }
+  static void unparse(String &JSON, const tsar::msg::LazySequence<T> &Obj) {
+    JSON += '[';
+    bool IsFirst = true;
+    Obj.for_each([&JSON, &IsFirst](const T &I) {
+      if (!IsFirst)
+        JSON += ',';
+      IsFirst = false;
+      Traits<T>::unparse(JSON, I);
+    });
+    JSON += ']';
+  }
+};
+
 template <> struct Traits<llvm::sys::fs::UniqueID> {
   inline static bool parse(llvm::sys::fs::UniqueID &Dest, Lexer &Lex) {
     auto &&[Count, MaxIdx, Ok] = Parser<>::numberOfKeys(Lex);
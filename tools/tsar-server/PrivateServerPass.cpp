@@ -21,6 +21,14 @@
 // This file implements a pass to interact with client software and to provide
 // results of loop traits analysis.
 //
+// Requests are processed one by one in a single worker thread, so a client
+// may submit requests asynchronously (msg::Submit), cancel pending requests
+// (msg::Cancel) and obtain answers in order of their completion (msg::Poll).
+// Long-running requests check for cancellation between analysis of
+// functions, so a stale request does not consume CPU. If there are no
+// requests in the queue, the worker thread analyzes user functions in
+// background and keeps results for later requests.
+//
 //===----------------------------------------------------------------------===//
 
 #include "ClangMessages.h"
@@ -29,6 +37,7 @@
 #include "tsar/Analysis/AnalysisServer.h"
 #include "tsar/Analysis/Attributes.h"
 #include "tsar/Analysis/DFRegionInfo.h"
+#include "tsar/Analysis/FunctionChanges.h"
 #include "tsar/Analysis/Clang/CanonicalLoop.h"
 #include "tsar/Analysis/Clang/ControlFlowTraits.h"
 #include "tsar/Analysis/Clang/LoopMatcher.h"
@@ -72,7 +81,13 @@
 #include <llvm/InitializePasses.h>
 #include <llvm/IR/InstIterator.h>
 #include <llvm/Pass.h>
+#include <llvm/Support/Debug.h>
 #include <llvm/Support/Path.h>
+#include <llvm/Support/ThreadPool.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 
 using namespace llvm;
 using namespace tsar;
@@ -178,12 +193,20 @@ JSON_OBJECT_PAIR_7(Loop,
   Loop & operator=(Loop &&) = default;
 JSON_OBJECT_END(Loop)
 
+/// \brief This message provides loops of a function.
+///
+/// Loops are listed in pre-order. If Depth is nonzero, loops at the deeper
+/// levels are omitted. Offset and Limit specify a page of loops to send,
+/// if Limit is zero all remaining loops are sent.
 JSON_OBJECT_BEGIN(LoopTree)
-JSON_OBJECT_ROOT_PAIR_2(LoopTree,
+JSON_OBJECT_ROOT_PAIR_5(LoopTree,
   FunctionID, std::uint64_t,
-  Loops, std::vector<Loop>)
+  Depth, unsigned,
+  Offset, unsigned,
+  Limit, unsigned,
+  Loops, LazySequence<Loop>)
 
-  LoopTree() : JSON_INIT_ROOT {}
+  LoopTree() : JSON_INIT_ROOT, JSON_INIT(LoopTree, 0, 0, 0, 0) {}
   ~LoopTree() override = default;
 
   LoopTree(const LoopTree &) = default;
@@ -352,14 +375,25 @@ JSON_OBJECT_PAIR_3(AliasEdge,
   AliasEdge & operator=(AliasEdge &&) = default;
 JSON_OBJECT_END(AliasEdge)
 
+/// \brief This message provides alias tree of a loop.
+///
+/// Nodes are listed in breadth-first order starting from the Root node or
+/// from the top-level nodes if Root is zero. If Depth is nonzero, nodes at the
+/// deeper levels are omitted. Offset and Limit specify a page of nodes to send,
+/// if Limit is zero all remaining nodes are sent. Edges from each sent node to
+/// all its children are sent, so client may request omitted subtrees later.
 JSON_OBJECT_BEGIN(AliasTree)
-JSON_OBJECT_ROOT_PAIR_4(AliasTree,
+JSON_OBJECT_ROOT_PAIR_8(AliasTree,
   FuncID, std::uint64_t,
   LoopID, std::uint64_t,
-  Nodes, std::vector<AliasNode>,
+  Root, std::uintptr_t,
+  Depth, unsigned,
+  Offset, unsigned,
+  Limit, unsigned,
+  Nodes, LazySequence<AliasNode>,
   Edges, std::vector<AliasEdge>)
 
-  AliasTree() : JSON_INIT_ROOT, JSON_INIT(AliasTree, 0) {}
+  AliasTree() : JSON_INIT_ROOT, JSON_INIT(AliasTree, 0, 0, 0, 0, 0, 0) {}
   ~AliasTree() override = default;
 
   AliasTree(const AliasTree &) = default;
@@ -368,6 +402,86 @@ JSON_OBJECT_ROOT_PAIR_4(AliasTree,
   AliasTree & operator=(AliasTree &&) = default;
 JSON_OBJECT_END(AliasTree)
 
+/// \brief This message submits a request which is processed asynchronously.
+///
+/// The request is a JSON string which contains one of messages known to
+/// server. The identifier is chosen by client, it must be nonzero and it must
+/// differ from identifiers of pending requests. Server immediately responds
+/// with a diagnostic, the answer should be obtained later with msg::Poll.
+JSON_OBJECT_BEGIN(Submit)
+JSON_OBJECT_ROOT_PAIR_2(Submit,
+  ID, std::uint64_t,
+  Request, std::string)
+
+  Submit() : JSON_INIT_ROOT, JSON_INIT(Submit, 0) {}
+  ~Submit() override = default;
+
+  Submit(const Submit &) = default;
+  Submit & operator=(const Submit &) = default;
+  Submit(Submit &&) = default;
+  Submit & operator=(Submit &&) = default;
+JSON_OBJECT_END(Submit)
+
+/// \brief This message cancels a pending request.
+///
+/// If the request is being processed, it is aborted at the nearest check.
+/// In any case, a reply with the Error status is sent for the cancelled
+/// request.
+JSON_OBJECT_BEGIN(Cancel)
+JSON_OBJECT_ROOT_PAIR(Cancel
+  , ID, std::uint64_t
+  )
+
+  Cancel() : JSON_INIT_ROOT, JSON_INIT(Cancel, 0) {}
+  ~Cancel() override = default;
+
+  Cancel(const Cancel &) = default;
+  Cancel & operator=(const Cancel &) = default;
+  Cancel(Cancel &&) = default;
+  Cancel & operator=(Cancel &&) = default;
+JSON_OBJECT_END(Cancel)
+
+/// \brief This message requests an answer for some of submitted requests.
+///
+/// If Wait is set, server waits for completion of a request. Note, that
+/// other messages can not be processed while server is waiting.
+JSON_OBJECT_BEGIN(Poll)
+JSON_OBJECT_ROOT_PAIR(Poll
+  , Wait, bool
+  )
+
+  Poll() : JSON_INIT_ROOT, JSON_INIT(Poll, false) {}
+  ~Poll() override = default;
+
+  Poll(const Poll &) = default;
+  Poll & operator=(const Poll &) = default;
+  Poll(Poll &&) = default;
+  Poll & operator=(Poll &&) = default;
+JSON_OBJECT_END(Poll)
+
+/// \brief This message is a response to msg::Poll.
+///
+/// The Status field is
+/// - Success if Response contains an answer for a request with identifier ID,
+/// - Error if a request with identifier ID has been cancelled,
+/// - Done if there are no completed requests (ID is zero in this case).
+/// The Pending field contains number of requests which are still pending.
+JSON_OBJECT_BEGIN(Reply)
+JSON_OBJECT_ROOT_PAIR_4(Reply,
+  ID, std::uint64_t,
+  Status, msg::Status,
+  Response, std::string,
+  Pending, unsigned)
+
+  Reply() : JSON_INIT_ROOT, JSON_INIT(Reply, 0, msg::Status::Done, "", 0) {}
+  ~Reply() override = default;
+
+  Reply(const Reply &) = default;
+  Reply & operator=(const Reply &) = default;
+  Reply(Reply &&) = default;
+  Reply & operator=(Reply &&) = default;
+JSON_OBJECT_END(Reply)
+
 JSON_OBJECT_BEGIN(Reduction)
 JSON_OBJECT_PAIR(Reduction, Kind, trait::Reduction::Kind)
   Reduction() : JSON_INIT(Reduction, trait::Reduction::RK_NoReduction) {}
@@ -409,6 +523,10 @@ JSON_DEFAULT_TRAITS(tsar::msg::, MemoryLocation)
 JSON_DEFAULT_TRAITS(tsar::msg::, AliasNode)
 JSON_DEFAULT_TRAITS(tsar::msg::, AliasEdge)
 JSON_DEFAULT_TRAITS(tsar::msg::, AliasTree)
+JSON_DEFAULT_TRAITS(tsar::msg::, Submit)
+JSON_DEFAULT_TRAITS(tsar::msg::, Cancel)
+JSON_DEFAULT_TRAITS(tsar::msg::, Poll)
+JSON_DEFAULT_TRAITS(tsar::msg::, Reply)
 JSON_DEFAULT_TRAITS(tsar::msg::, Reduction)
 JSON_DEFAULT_TRAITS(tsar::msg::, Induction)
 JSON_DEFAULT_TRAITS(tsar::msg::, Dependence)
@@ -870,6 +988,23 @@ INITIALIZE_PROVIDER_END(ServerPrivateProvider, "server-private-provider",
   "Server Private Provider")
 
 namespace {
+/// Number of traits in a map.
+using TraitCountMap = bcl::StaticTraitMap<unsigned, MemoryDescriptor>;
+
+/// Sets to zero counts of traits in a map the functor is applied to.
+struct InitTraitCountFunctor {
+  template<class Trait> void operator()(unsigned &C) { C = 0; }
+};
+
+/// Adds counts of traits from a specified map to a map the functor is
+/// applied to.
+struct AddTraitCountFunctor {
+  template<class Trait> void operator()(unsigned &C) {
+    C += From.template value<Trait>();
+  }
+  const TraitCountMap &From;
+};
+
 /// Interacts with a client and sends result of analysis on request.
 class PrivateServerPass :
   public ModulePass, private bcl::Uncopyable {
@@ -888,6 +1023,51 @@ class PrivateServerPass :
       bcl::tagged<Definition *, Definition>,
       bcl::tagged<SmallPtrSet<clang::FunctionDecl *, 4>, clang::FunctionDecl>>>;
 
+  /// Function which is visible to user and a context it is declared in.
+  struct FunctionEntry {
+    llvm::Function *F;
+    llvm::DICompileUnit *CU;
+    ClangTransformationContext *TfmCtx;
+  };
+
+  /// Map from a function identifier which is used in messages to a function.
+  using FunctionIndex = DenseMap<uint64_t, FunctionEntry>;
+
+  /// Map from a loop identifier which is used in messages to a loop statement.
+  ///
+  /// Only AST-level loops are stored because they are not changed during
+  /// the session. IR-level loops are recomputed each time a provider is
+  /// rerun, so they are obtained from the current loop matcher on request.
+  using LoopIndex = DenseMap<uint64_t, clang::Stmt *>;
+
+  /// Results of analysis of a function which are reused between requests.
+  ///
+  /// On the fly passes hold results for the last analyzed function only, so
+  /// results which are necessary to answer requests are collected once and
+  /// they are kept until the end of the session. Loops are sorted in pre-order
+  /// and their levels are computed.
+  struct FunctionSummary {
+    FunctionSummary() { Traits.for_each(InitTraitCountFunctor()); }
+    std::vector<msg::Loop> Loops;
+    unsigned AnalyzedLoops = 0;
+    unsigned NotAnalyzedLoops = 0;
+    unsigned ParallelLoops = 0;
+    TraitCountMap Traits;
+  };
+
+  using LoopEntry = bcl::tagged_pair<
+    bcl::tagged<clang::Stmt *, AST>,
+    bcl::tagged<Loop *, IR>>;
+
+  /// Request which has been submitted to be processed asynchronously.
+  struct AsyncRequest {
+    AsyncRequest(uint64_t Id, std::string Request)
+        : Id(Id), Request(std::move(Request)) {}
+    uint64_t Id;
+    std::string Request;
+    std::atomic<bool> IsCancelled{false};
+  };
+
 public:
   /// Pass identification, replacement for typeid.
   static char ID;
@@ -911,6 +1091,31 @@ public:
   void getAnalysisUsage(AnalysisUsage &AU) const override;
 
 private:
+  /// Process a request of one of known types, this is called in the worker
+  /// thread only.
+  std::string answer(llvm::Module &M, const std::string &Request);
+
+  std::string answerSubmit(llvm::Module &M, const msg::Submit &Request);
+  std::string answerCancel(const msg::Cancel &Request);
+  std::string answerPoll(const msg::Poll &Request);
+
+  /// Process an asynchronous request and store a reply for it.
+  void runAsync(llvm::Module &M, std::shared_ptr<AsyncRequest> Request);
+
+  /// Return true if processing of the current request has been cancelled.
+  bool isCancelled() const {
+    return mActiveRequest &&
+           mActiveRequest->IsCancelled.load(std::memory_order_relaxed);
+  }
+
+  /// Return provider which holds results of analysis for a specified
+  /// function, results of the last execution are reused if the function
+  /// has not been modified.
+  ServerPrivateProvider &getProvider(llvm::Function &F) {
+    return getCachedProvider<ServerPrivateProvider>(
+        *this, F, mChanges ? mChanges->getVersion(F) : 0);
+  }
+
   std::string answerStatistic(llvm::Module &M);
   std::string answerFileList();
   std::string answerFunctionList(llvm::Module &M);
@@ -925,11 +1130,63 @@ private:
       llvm::DICompileUnit &CU, ClangTransformationContext &TfmCtx,
       TypeToFunctionMap &TypeToFunc, msg::FunctionList &FuncList);
 
+  /// Return results of analysis for a specified function, analyze the
+  /// function if it has not been analyzed yet.
+  ///
+  /// Background analysis and requests are processed in the same worker
+  /// thread. So, if a function is being analyzed in background, a request
+  /// waits in the queue until the analysis finishes and reuses its results.
+  const FunctionSummary & summarize(llvm::Module &M, llvm::Function &F,
+    llvm::DICompileUnit &CU, ClangTransformationContext &TfmCtx);
+
+  /// Analyze functions from a specified list which have not been analyzed yet.
+  ///
+  /// Return false if analysis has been cancelled.
+  bool precompute(llvm::Module &M, llvm::DICompileUnit &CU,
+    ClangTransformationContext &TfmCtx, ArrayRef<llvm::Function *> Funcs);
+
+  /// Schedule the next step of background analysis if it has not been
+  /// scheduled yet.
+  void scheduleBackground(llvm::Module &M);
+
+  /// Analyze a single function in background if there are no requests in
+  /// the queue and schedule the next step.
+  ///
+  /// Functions which have been already requested by user are analyzed first
+  /// in order of requests, then larger functions are analyzed before smaller
+  /// ones.
+  void runBackground(llvm::Module &M);
+
+  /// Collect user functions which should be analyzed in background.
+  void collectBackground(llvm::Module &M);
+
+  /// Return a function with a specified identifier or nullptr if there is no
+  /// such function visible to user.
+  ///
+  /// The index is built on the first request after the list of visible
+  /// functions has been changed, so each lookup takes constant time.
+  const FunctionEntry * findFunction(llvm::Module &M, uint64_t FuncId);
+
+  /// Return a loop with a specified identifier in a specified function.
+  ///
+  /// The AST-level loop is null if there is no such loop. The IR-level loop
+  /// is null if the loop has not been matched.
+  LoopEntry findLoop(llvm::Module &M, const FunctionEntry &FE,
+    const LoopMatcherPass &LMP, uint64_t LoopId);
+
+  /// Invalidate indices which map identifiers to functions and loops.
+  void invalidateIndex() {
+    mFunctionIndex.clear();
+    mLoopIndex.clear();
+    mIsFunctionIndexValid = false;
+  }
+
   bcl::IntrusiveConnection *mConnection;
   bcl::RedirectIO *mStdErr;
 
   TransformationInfo *mTfmInfo = nullptr;
   const GlobalOptions *mGlobalOpts = nullptr;
+  const FunctionChangeInfo *mChanges = nullptr;
   AnalysisSocket *mSocket = nullptr;
   GlobalsAAResult * mGlobalsAA = nullptr;
 
@@ -939,8 +1196,51 @@ private:
   /// GUI knowns this function and it can highlight some information if
   /// necessary.
   DenseMap<clang::Decl *, Definition *> mVisibleToUser;
+
+  FunctionIndex mFunctionIndex;
+  bool mIsFunctionIndexValid = false;
+  DenseMap<llvm::Function *, LoopIndex> mLoopIndex;
+
+  DenseMap<llvm::Function *, std::unique_ptr<FunctionSummary>> mSummaries;
+
+  /// Functions which have been requested by user with order of the first
+  /// request for each function.
+  DenseMap<llvm::Function *, unsigned> mRequested;
+
+  /// User functions to analyze in background, larger functions go first.
+  std::vector<FunctionEntry> mBackground;
+  std::size_t mNextBackground = 0;
+  bool mIsBackgroundCollected = false;
+  bool mIsBackgroundScheduled = false;
+
+  /// Number of requests which are waiting in the queue of the worker thread,
+  /// background analysis is suspended while there are such requests.
+  std::atomic<unsigned> mQueuedRequests{0};
+  std::atomic<bool> mStopBackground{false};
+
+  /// Thread which processes all requests, passes are never executed
+  /// concurrently.
+  std::unique_ptr<ThreadPool> mWorker;
+
+  /// Asynchronous request which is processed at the moment (accessed from
+  /// the worker thread only).
+  AsyncRequest *mActiveRequest = nullptr;
+
+  /// The following members are shared between the worker thread and the
+  /// thread which communicates with client.
+  std::mutex mAsyncMutex;
+  std::condition_variable mAsyncReady;
+  DenseMap<uint64_t, std::shared_ptr<AsyncRequest>> mPending;
+  std::deque<msg::Reply> mReplies;
 };
 
+/// Return a diagnostic which reports that a request has been cancelled.
+std::string answerCancelled() {
+  msg::Diagnostic Diag(msg::Status::Error);
+  Diag[msg::Diagnostic::Error].push_back("request has been cancelled");
+  return ::json::Parser<msg::Diagnostic>::unparseAsObject(Diag);
+}
+
 Optional<uint64_t> toId(llvm::Module *M, llvm::DICompileUnit *CU,
               clang::SourceLocation Loc) {
   assert(M && "Module must not be null!");
@@ -958,6 +1258,59 @@ Optional<uint64_t> toId(llvm::Module *M, llvm::DICompileUnit *CU,
   return None;
 }
 
+auto PrivateServerPass::findFunction(llvm::Module &M, uint64_t FuncId)
+    -> const FunctionEntry * {
+  if (!mIsFunctionIndexValid) {
+    for (Function &F : M) {
+      auto *DISub{findMetadata(&F)};
+      if (!DISub)
+        continue;
+      auto *CU{DISub->getUnit()};
+      auto *TfmCtx{dyn_cast_or_null<ClangTransformationContext>(
+          mTfmInfo->getContext(*CU))};
+      if (!TfmCtx || !TfmCtx->hasInstance())
+        continue;
+      auto Decl = TfmCtx->getDeclForMangledName(F.getName());
+      if (!Decl)
+        continue;
+      auto CanonicalFD = Decl->getCanonicalDecl()->getAsFunction();
+      auto DefItr{mVisibleToUser.find(CanonicalFD)};
+      if (DefItr == mVisibleToUser.end())
+        continue;
+      // The first function in the module has priority, so do not override
+      // existing entries.
+      mFunctionIndex.try_emplace(DefItr->second->Id, FunctionEntry{&F, CU,
+                                                                    TfmCtx});
+    }
+    mIsFunctionIndexValid = true;
+  }
+  auto I{mFunctionIndex.find(FuncId)};
+  return I != mFunctionIndex.end() ? &I->second : nullptr;
+}
+
+auto PrivateServerPass::findLoop(llvm::Module &M, const FunctionEntry &FE,
+    const LoopMatcherPass &LMP, uint64_t LoopId) -> LoopEntry {
+  auto &Matcher{LMP.getMatcher()};
+  auto [IndexItr, IsNew] = mLoopIndex.try_emplace(FE.F);
+  if (IsNew) {
+    // Matched loops have priority over unmatched ones.
+    for (auto &Match : Matcher)
+      if (auto Id{toId(&M, FE.CU, Match.get<AST>()->getBeginLoc())})
+        IndexItr->second.try_emplace(*Id, Match.get<AST>());
+    for (auto *Unmatch : LMP.getUnmatchedAST())
+      if (auto Id{toId(&M, FE.CU, Unmatch->getBeginLoc())})
+        IndexItr->second.try_emplace(*Id, Unmatch);
+  }
+  LoopEntry Loop(nullptr, nullptr);
+  auto I{IndexItr->second.find(LoopId)};
+  if (I == IndexItr->second.end())
+    return Loop;
+  Loop.get<AST>() = I->second;
+  if (auto MatchItr{Matcher.find<AST>(I->second)}; MatchItr != Matcher.end())
+    Loop.get<IR>() = MatchItr->get<IR>();
+  return Loop;
+}
+
 /// Increments count of analyzed traits in a specified map TM.
 template<class TraitMap>
 std::pair<unsigned, unsigned> incrementTraitCount(Function &F,
@@ -1044,6 +1397,7 @@ INITIALIZE_PASS_DEPENDENCY(GlobalDefinedMemoryWrapper)
 INITIALIZE_PASS_DEPENDENCY(GlobalLiveMemoryWrapper)
 INITIALIZE_PASS_DEPENDENCY(GlobalsAAWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(GlobalsAccessWrapper)
+INITIALIZE_PASS_DEPENDENCY(FunctionChangeWrapper)
 INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(DFRegionInfoPass)
 INITIALIZE_PASS_DEPENDENCY(DIEstimateMemoryPass)
@@ -1056,6 +1410,196 @@ INITIALIZE_PASS_DEPENDENCY(CanonicalLoopPass)
 INITIALIZE_PASS_END(PrivateServerPass, "server-private",
   "Server Private Pass", true, true)
 
+auto PrivateServerPass::summarize(llvm::Module &M, llvm::Function &F,
+    llvm::DICompileUnit &CU, ClangTransformationContext &TfmCtx)
+    -> const FunctionSummary & {
+  assert(!F.isDeclaration() && "Function must have a body!");
+  auto [SummaryItr, IsNew] = mSummaries.try_emplace(&F);
+  if (!IsNew)
+    return *SummaryItr->second;
+  SummaryItr->second = std::make_unique<FunctionSummary>();
+  auto &Summary{*SummaryItr->second};
+  auto &SrcMgr = TfmCtx.getContext().getSourceManager();
+  auto &Provider = getProvider(F);
+  auto &Matcher = Provider.get<LoopMatcherPass>().getMatcher();
+  auto &Unmatcher = Provider.get<LoopMatcherPass>().getUnmatchedAST();
+  auto &RegionInfo = Provider.get<DFRegionInfoPass>().getRegionInfo();
+  auto &PerfectInfo = Provider.get<ClangPerfectLoopPass>().
+    getPerfectLoopInfo();
+  auto &CanonicalInfo = Provider.get<CanonicalLoopPass>().
+    getCanonicalLoopInfo();
+  auto &AttrsInfo = Provider.get<LoopAttributesDeductionPass>();
+  auto &CFLoopInfo = Provider.get<ClangCFTraitsPass>().getLoopInfo();
+  auto &ParallelInfo = Provider.get<ParallelLoopPass>().getParallelLoopInfo();
+  for (auto &Match : Matcher) {
+    auto Loop = getLoopInfo(Match.get<AST>(), SrcMgr, M, CU);
+    auto &LT = Loop[msg::Loop::Traits];
+    LT[msg::LoopTraits::IsAnalyzed] = msg::Analysis::Yes;
+    auto CI = CanonicalInfo.find_as(RegionInfo.getRegionFor(Match.get<IR>()));
+    if (CI != CanonicalInfo.end() && (**CI).isCanonical())
+      LT[msg::LoopTraits::Canonical] = msg::Analysis::Yes;
+    if (PerfectInfo.count(RegionInfo.getRegionFor(Match.get<IR>())))
+      LT[msg::LoopTraits::Perfect] = msg::Analysis::Yes;
+    if (AttrsInfo.hasAttr(*Match.get<IR>(), AttrKind::NoIO))
+      LT[msg::LoopTraits::InOut] = msg::Analysis::No;
+    if (AttrsInfo.hasAttr(*Match.get<IR>(), AttrKind::AlwaysReturn) &&
+        AttrsInfo.hasAttr(*Match.get<IR>(), Attribute::NoUnwind) &&
+        !AttrsInfo.hasAttr(*Match.get<IR>(), Attribute::ReturnsTwice))
+      LT[msg::LoopTraits::UnsafeCFG] = msg::Analysis::No;
+    Loop[msg::Loop::Exit] = 0;
+    for (auto *BB : Match.get<IR>()->blocks()) {
+      if (Match.get<IR>()->isLoopExiting(BB))
+        ++*Loop[msg::Loop::Exit];
+    }
+    if (ParallelInfo.count(Match.get<IR>()))
+      LT[msg::LoopTraits::Parallel] = msg::Analysis::Yes;
+    Summary.Loops.push_back(std::move(Loop));
+  }
+  for (auto &Unmatch : Unmatcher) {
+    auto Loop = getLoopInfo(Unmatch, SrcMgr, M, CU);
+    auto &LT = Loop[msg::Loop::Traits];
+    LT[msg::LoopTraits::IsAnalyzed] = msg::Analysis::No;
+    Summary.Loops.push_back(std::move(Loop));
+  }
+  std::sort(Summary.Loops.begin(),
+    Summary.Loops.end(),
+    [](msg::Loop &LHS, msg::Loop &RHS) -> bool {
+      return
+        (LHS[msg::Loop::StartLocation][msg::Location::Line] <
+            RHS[msg::Loop::StartLocation][msg::Location::Line]) ||
+        ((LHS[msg::Loop::StartLocation][msg::Location::Line] ==
+            RHS[msg::Loop::StartLocation][msg::Location::Line]) &&
+        (LHS[msg::Loop::StartLocation][msg::Location::Column] <
+            RHS[msg::Loop::StartLocation][msg::Location::Column])) ||
+        ((LHS[msg::Loop::StartLocation][msg::Location::Line] ==
+            RHS[msg::Loop::StartLocation][msg::Location::Line]) &&
+        (LHS[msg::Loop::StartLocation][msg::Location::Column] ==
+            RHS[msg::Loop::StartLocation][msg::Location::Column]) &&
+        (LHS[msg::Loop::StartLocation][msg::Location::MacroLine] <
+            RHS[msg::Loop::StartLocation][msg::Location::MacroLine])) ||
+        ((LHS[msg::Loop::StartLocation][msg::Location::Line] ==
+            RHS[msg::Loop::StartLocation][msg::Location::Line]) &&
+        (LHS[msg::Loop::StartLocation][msg::Location::Column] ==
+            RHS[msg::Loop::StartLocation][msg::Location::Column]) &&
+        (LHS[msg::Loop::StartLocation][msg::Location::MacroLine] ==
+            RHS[msg::Loop::StartLocation][msg::Location::MacroLine]) &&
+        (LHS[msg::Loop::StartLocation][msg::Location::MacroColumn] <
+            RHS[msg::Loop::StartLocation][msg::Location::MacroColumn]));
+  });
+  std::vector<msg::Location> Levels;
+  for (auto &Loop : Summary.Loops) {
+    while (!Levels.empty() &&
+        ((Levels[Levels.size() - 1][msg::Location::Line] <
+            Loop[msg::Loop::EndLocation][msg::Location::Line]) ||
+        ((Levels[Levels.size() - 1][msg::Location::Line] ==
+            Loop[msg::Loop::EndLocation][msg::Location::Line]) &&
+        (Levels[Levels.size() - 1][msg::Location::Column] <
+            Loop[msg::Loop::EndLocation][msg::Location::Column])) ||
+        ((Levels[Levels.size() - 1][msg::Location::Line] ==
+            Loop[msg::Loop::EndLocation][msg::Location::Line]) &&
+        (Levels[Levels.size() - 1][msg::Location::Column] ==
+            Loop[msg::Loop::EndLocation][msg::Location::Column]) &&
+        (Levels[Levels.size() - 1][msg::Location::MacroLine] <
+            Loop[msg::Loop::EndLocation][msg::Location::MacroLine])) ||
+        ((Levels[Levels.size() - 1][msg::Location::Line] ==
+            Loop[msg::Loop::EndLocation][msg::Location::Line]) &&
+        (Levels[Levels.size() - 1][msg::Location::Column] ==
+            Loop[msg::Loop::EndLocation][msg::Location::Column]) &&
+        (Levels[Levels.size() - 1][msg::Location::MacroLine] ==
+            Loop[msg::Loop::EndLocation][msg::Location::MacroLine]) &&
+        (Levels[Levels.size() - 1][msg::Location::MacroColumn] <
+            Loop[msg::Loop::EndLocation][msg::Location::MacroColumn]))))
+      Levels.pop_back();
+    Loop[msg::Loop::Level] = Levels.size() + 1;
+    Levels.push_back(Loop[msg::Loop::EndLocation]);
+  }
+  auto &LMP = Provider.get<LoopMatcherPass>();
+  auto [ParallelLoops, NotAnalyzedLoops] =
+      incrementTraitCount(F, *mGlobalOpts, Provider, *mSocket, Summary.Traits);
+  Summary.AnalyzedLoops = LMP.getMatcher().size() - NotAnalyzedLoops;
+  Summary.NotAnalyzedLoops = LMP.getUnmatchedAST().size() + NotAnalyzedLoops;
+  Summary.ParallelLoops = ParallelLoops;
+  return Summary;
+}
+
+bool PrivateServerPass::precompute(llvm::Module &M, llvm::DICompileUnit &CU,
+    ClangTransformationContext &TfmCtx, ArrayRef<llvm::Function *> Funcs) {
+  for (auto *F : Funcs) {
+    if (mSummaries.count(F))
+      continue;
+    if (isCancelled())
+      return false;
+    LLVM_DEBUG(dbgs() << "[SERVER]: precompute analysis for " << F->getName()
+                      << "\n");
+    summarize(M, *F, CU, TfmCtx);
+  }
+  return true;
+}
+
+void PrivateServerPass::scheduleBackground(llvm::Module &M) {
+  if (mIsBackgroundScheduled || mStopBackground)
+    return;
+  mIsBackgroundScheduled = true;
+  mWorker->async([this, &M]() { runBackground(M); });
+}
+
+void PrivateServerPass::collectBackground(llvm::Module &M) {
+  mIsBackgroundCollected = true;
+  for (auto &&[CU, TfmCtxBase] : mTfmInfo->contexts()) {
+    if (!TfmCtxBase || !TfmCtxBase->hasInstance())
+      continue;
+    auto *TfmCtx{dyn_cast<ClangTransformationContext>(TfmCtxBase)};
+    if (!TfmCtx)
+      continue;
+    auto &SrcMgr{TfmCtx->getRewriter().getSourceMgr()};
+    for (Function &F : M) {
+      if (F.isDeclaration())
+        continue;
+      auto Decl{TfmCtx->getDeclForMangledName(F.getName())};
+      if (!Decl || SrcMgr.getFileCharacteristic(Decl->getBeginLoc()) !=
+                       clang::SrcMgr::C_User)
+        continue;
+      mBackground.push_back(FunctionEntry{&F, CU, TfmCtx});
+    }
+  }
+  std::stable_sort(mBackground.begin(), mBackground.end(),
+                   [](const FunctionEntry &LHS, const FunctionEntry &RHS) {
+                     return LHS.F->getInstructionCount() >
+                            RHS.F->getInstructionCount();
+                   });
+}
+
+void PrivateServerPass::runBackground(llvm::Module &M) {
+  mIsBackgroundScheduled = false;
+  // Requests have priority, background analysis is resumed when all queued
+  // requests are processed.
+  if (mStopBackground || mQueuedRequests > 0)
+    return;
+  if (!mIsBackgroundCollected)
+    collectBackground(M);
+  const FunctionEntry *Next{nullptr};
+  unsigned NextOrder{0};
+  for (auto &FE : mBackground)
+    if (auto I{mRequested.find(FE.F)}; I != mRequested.end() &&
+        !mSummaries.count(FE.F) && (!Next || I->second < NextOrder)) {
+      Next = &FE;
+      NextOrder = I->second;
+    }
+  if (!Next) {
+    for (; mNextBackground < mBackground.size() &&
+           mSummaries.count(mBackground[mNextBackground].F);
+         ++mNextBackground)
+      ;
+    if (mNextBackground == mBackground.size())
+      return;
+    Next = &mBackground[mNextBackground];
+  }
+  LLVM_DEBUG(dbgs() << "[SERVER]: background analysis for "
+                    << Next->F->getName() << "\n");
+  summarize(M, *Next->F, *Next->CU, *Next->TfmCtx);
+  scheduleBackground(M);
+}
+
 std::string PrivateServerPass::answerStatistic(llvm::Module &M) {
   msg::Statistic Stat;
   for (auto &&[CU, TfmCtxBase] : mTfmInfo->contexts()) {
@@ -1090,6 +1634,7 @@ std::string PrivateServerPass::answerStatistic(llvm::Module &M) {
           std::make_pair(msg::Analysis::No, MMP->UnmatchedAST.size()));
       std::pair<unsigned, unsigned> Loops(0, 0);
       auto &SrcMgr = Rewriter.getSourceMgr();
+      std::vector<Function *> UserFuncs;
       for (Function &F : M) {
         if (isMemoryMarkerIntrinsic(F.getIntrinsicID()) ||
             isDbgInfoIntrinsic(F.getIntrinsicID()))
@@ -1105,15 +1650,17 @@ std::string PrivateServerPass::answerStatistic(llvm::Module &M) {
         // Analysis are not available for functions without body.
         if (F.isDeclaration())
           continue;
-        auto &Provider = getAnalysis<ServerPrivateProvider>(F);
-        auto &LMP = Provider.get<LoopMatcherPass>();
-        Loops.first += LMP.getMatcher().size();
-        Loops.second += LMP.getUnmatchedAST().size();
-        auto [ParallelLoops, NotAnalyzedLoops] = incrementTraitCount(
-            F, *mGlobalOpts, Provider, *mSocket, Stat[msg::Statistic::Traits]);
-        Stat[msg::Statistic::ParallelLoops] += ParallelLoops;
-        Loops.first -= NotAnalyzedLoops;
-        Loops.second += NotAnalyzedLoops;
+        UserFuncs.push_back(&F);
+      }
+      if (!precompute(M, *CU, *TfmCtx, UserFuncs))
+        return answerCancelled();
+      for (auto *F : UserFuncs) {
+        auto &Summary{*mSummaries[F]};
+        Loops.first += Summary.AnalyzedLoops;
+        Loops.second += Summary.NotAnalyzedLoops;
+        Stat[msg::Statistic::ParallelLoops] += Summary.ParallelLoops;
+        Stat[msg::Statistic::Traits].for_each(
+            AddTraitCountFunctor{Summary.Traits});
       }
       Stat[msg::Statistic::Loops].insert(
           std::make_pair(msg::Analysis::Yes, Loops.first));
@@ -1126,121 +1673,38 @@ std::string PrivateServerPass::answerStatistic(llvm::Module &M) {
 
 std::string PrivateServerPass::answerLoopTree(llvm::Module &M,
     const msg::LoopTree &Request) {
-  for (Function &F : M) {
-    auto *DISub{findMetadata(&F)};
-    if (!DISub)
-      continue;
-    auto *CU{DISub->getUnit()};
-    auto *TfmCtx{dyn_cast_or_null<ClangTransformationContext>(
-        mTfmInfo->getContext(*CU))};
-    if (!TfmCtx || !TfmCtx->hasInstance())
-      continue;
-    auto Decl = TfmCtx->getDeclForMangledName(F.getName());
-    if (!Decl)
-      continue;
-    auto CanonicalFD = Decl->getCanonicalDecl()->getAsFunction();
-    auto DefItr{mVisibleToUser.find(CanonicalFD)};
-    if (DefItr == mVisibleToUser.end() ||
-        DefItr->second->Id != Request[msg::LoopTree::FunctionID])
-      continue;
+  if (auto *FE{findFunction(M, Request[msg::LoopTree::FunctionID])}) {
+    auto &F{*FE->F};
+    auto *CU{FE->CU};
+    auto *TfmCtx{FE->TfmCtx};
     if (F.isDeclaration())
       return ::json::Parser<msg::LoopTree>::unparseAsObject(Request);
-    msg::LoopTree LoopTree;
-    LoopTree[msg::LoopTree::FunctionID] = Request[msg::LoopTree::FunctionID];
-    auto &SrcMgr = TfmCtx->getContext().getSourceManager();
-    auto &Provider = getAnalysis<ServerPrivateProvider>(F);
-    auto &Matcher = Provider.get<LoopMatcherPass>().getMatcher();
-    auto &Unmatcher = Provider.get<LoopMatcherPass>().getUnmatchedAST();
-    auto &RegionInfo = Provider.get<DFRegionInfoPass>().getRegionInfo();
-    auto &PerfectInfo = Provider.get<ClangPerfectLoopPass>().
-      getPerfectLoopInfo();
-    auto &CanonicalInfo = Provider.get<CanonicalLoopPass>().
-      getCanonicalLoopInfo();
-    auto &AttrsInfo = Provider.get<LoopAttributesDeductionPass>();
-    auto &CFLoopInfo = Provider.get<ClangCFTraitsPass>().getLoopInfo();
-    auto &ParallelInfo = Provider.get<ParallelLoopPass>().getParallelLoopInfo();
-    for (auto &Match : Matcher) {
-      auto Loop = getLoopInfo(Match.get<AST>(), SrcMgr, M, *CU);
-      auto &LT = Loop[msg::Loop::Traits];
-      LT[msg::LoopTraits::IsAnalyzed] = msg::Analysis::Yes;
-      auto CI = CanonicalInfo.find_as(RegionInfo.getRegionFor(Match.get<IR>()));
-      if (CI != CanonicalInfo.end() && (**CI).isCanonical())
-        LT[msg::LoopTraits::Canonical] = msg::Analysis::Yes;
-      if (PerfectInfo.count(RegionInfo.getRegionFor(Match.get<IR>())))
-        LT[msg::LoopTraits::Perfect] = msg::Analysis::Yes;
-      if (AttrsInfo.hasAttr(*Match.get<IR>(), AttrKind::NoIO))
-        LT[msg::LoopTraits::InOut] = msg::Analysis::No;
-      if (AttrsInfo.hasAttr(*Match.get<IR>(), AttrKind::AlwaysReturn) &&
-          AttrsInfo.hasAttr(*Match.get<IR>(), Attribute::NoUnwind) &&
-          !AttrsInfo.hasAttr(*Match.get<IR>(), Attribute::ReturnsTwice))
-        LT[msg::LoopTraits::UnsafeCFG] = msg::Analysis::No;
-      Loop[msg::Loop::Exit] = 0;
-      for (auto *BB : Match.get<IR>()->blocks()) {
-        if (Match.get<IR>()->isLoopExiting(BB))
-          ++*Loop[msg::Loop::Exit];
-      }
-      if (ParallelInfo.count(Match.get<IR>()))
-        LT[msg::LoopTraits::Parallel] = msg::Analysis::Yes;
-      LoopTree[msg::LoopTree::Loops].push_back(std::move(Loop));
-    }
-    for (auto &Unmatch : Unmatcher) {
-      auto Loop = getLoopInfo(Unmatch, SrcMgr, M, *CU);
-      auto &LT = Loop[msg::Loop::Traits];
-      LT[msg::LoopTraits::IsAnalyzed] = msg::Analysis::No;
-      LoopTree[msg::LoopTree::Loops].push_back(std::move(Loop));
-    }
-    std::sort(LoopTree[msg::LoopTree::Loops].begin(),
-      LoopTree[msg::LoopTree::Loops].end(),
-      [](msg::Loop &LHS, msg::Loop &RHS) -> bool {
-        return
-          (LHS[msg::Loop::StartLocation][msg::Location::Line] <
-              RHS[msg::Loop::StartLocation][msg::Location::Line]) ||
-          ((LHS[msg::Loop::StartLocation][msg::Location::Line] ==
-              RHS[msg::Loop::StartLocation][msg::Location::Line]) &&
-          (LHS[msg::Loop::StartLocation][msg::Location::Column] <
-              RHS[msg::Loop::StartLocation][msg::Location::Column])) ||
-          ((LHS[msg::Loop::StartLocation][msg::Location::Line] ==
-              RHS[msg::Loop::StartLocation][msg::Location::Line]) &&
-          (LHS[msg::Loop::StartLocation][msg::Location::Column] ==
-              RHS[msg::Loop::StartLocation][msg::Location::Column]) &&
-          (LHS[msg::Loop::StartLocation][msg::Location::MacroLine] <
-              RHS[msg::Loop::StartLocation][msg::Location::MacroLine])) ||
-          ((LHS[msg::Loop::StartLocation][msg::Location::Line] ==
-              RHS[msg::Loop::StartLocation][msg::Location::Line]) &&
-          (LHS[msg::Loop::StartLocation][msg::Location::Column] ==
-              RHS[msg::Loop::StartLocation][msg::Location::Column]) &&
-          (LHS[msg::Loop::StartLocation][msg::Location::MacroLine] ==
-              RHS[msg::Loop::StartLocation][msg::Location::MacroLine]) &&
-          (LHS[msg::Loop::StartLocation][msg::Location::MacroColumn] <
-              RHS[msg::Loop::StartLocation][msg::Location::MacroColumn]));
-    });
-    std::vector<msg::Location> Levels;
-    for (auto &Loop : LoopTree[msg::LoopTree::Loops]) {
-      while (!Levels.empty() &&
-          ((Levels[Levels.size() - 1][msg::Location::Line] <
-              Loop[msg::Loop::EndLocation][msg::Location::Line]) ||
-          ((Levels[Levels.size() - 1][msg::Location::Line] ==
-              Loop[msg::Loop::EndLocation][msg::Location::Line]) &&
-          (Levels[Levels.size() - 1][msg::Location::Column] <
-              Loop[msg::Loop::EndLocation][msg::Location::Column])) ||
-          ((Levels[Levels.size() - 1][msg::Location::Line] ==
-              Loop[msg::Loop::EndLocation][msg::Location::Line]) &&
-          (Levels[Levels.size() - 1][msg::Location::Column] ==
-              Loop[msg::Loop::EndLocation][msg::Location::Column]) &&
-          (Levels[Levels.size() - 1][msg::Location::MacroLine] <
-              Loop[msg::Loop::EndLocation][msg::Location::MacroLine])) ||
-          ((Levels[Levels.size() - 1][msg::Location::Line] ==
-              Loop[msg::Loop::EndLocation][msg::Location::Line]) &&
-          (Levels[Levels.size() - 1][msg::Location::Column] ==
-              Loop[msg::Loop::EndLocation][msg::Location::Column]) &&
-          (Levels[Levels.size() - 1][msg::Location::MacroLine] ==
-              Loop[msg::Loop::EndLocation][msg::Location::MacroLine]) &&
-          (Levels[Levels.size() - 1][msg::Location::MacroColumn] <
-              Loop[msg::Loop::EndLocation][msg::Location::MacroColumn]))))
-        Levels.pop_back();
-      Loop[msg::Loop::Level] = Levels.size() + 1;
-      Levels.push_back(Loop[msg::Loop::EndLocation]);
-    }
+    mRequested.try_emplace(&F, mRequested.size());
+    auto &Summary{summarize(M, F, *CU, *TfmCtx)};
+    msg::LoopTree LoopTree{Request};
+    LoopTree[msg::LoopTree::Loops].items().clear();
+    // Loops are not copied to the response, each loop is unparsed straight
+    // from the summary.
+    LoopTree[msg::LoopTree::Loops].setGenerator(
+        [&Summary, Depth = Request[msg::LoopTree::Depth],
+         Skip = Request[msg::LoopTree::Offset],
+         Limit = Request[msg::LoopTree::Limit], Count = 0u,
+         I = std::size_t(0)](msg::Loop &Loop) mutable {
+          for (; I < Summary.Loops.size(); ++I) {
+            if (Depth && Summary.Loops[I][msg::Loop::Level] > Depth)
+              continue;
+            if (Skip > 0) {
+              --Skip;
+              continue;
+            }
+            if (Limit && Count == Limit)
+              return false;
+            ++Count;
+            Loop = Summary.Loops[I++];
+            return true;
+          }
+          return false;
+        });
     return ::json::Parser<msg::LoopTree>::unparseAsObject(LoopTree);
   }
   return ::json::Parser<msg::LoopTree>::unparseAsObject(Request);
@@ -1314,6 +1778,7 @@ std::string PrivateServerPass::answerFileList() {
 }
 
 std::string PrivateServerPass::answerFunctionList(llvm::Module &M) {
+  invalidateIndex();
   msg::FunctionList FuncList;
   for (Function &F : M) {
     auto *DISub{findMetadata(&F)};
@@ -1367,7 +1832,7 @@ std::string PrivateServerPass::answerFunctionList(llvm::Module &M) {
       Func[msg::Function::Traits][msg::FunctionTraits::InOut]
         = msg::Analysis::No;
     if (!F.isDeclaration()) {
-      auto &Provider = getAnalysis<ServerPrivateProvider>(F);
+      auto &Provider = getProvider(F);
       auto &LMP = Provider.get<LoopMatcherPass>();
       auto &AA = Provider.get<AAResultsWrapperPass>().getAAResults();
       auto &PI = Provider.get<ParallelLoopPass>().getParallelLoopInfo();
@@ -1430,51 +1895,22 @@ std::string PrivateServerPass::answerFunctionList(llvm::Module &M) {
 
 std::string PrivateServerPass::answerCalleeFuncList(llvm::Module &M,
     const msg::CalleeFuncList &Request) {
-  for (Function &F : M) {
-    auto *DISub{findMetadata(&F)};
-    if (!DISub)
-      continue;
-    auto *CU{DISub->getUnit()};
-    auto *TfmCtx{dyn_cast_or_null<ClangTransformationContext>(
-        mTfmInfo->getContext(*CU))};
-    if (!TfmCtx || !TfmCtx->hasInstance())
-      continue;
-    auto Decl = TfmCtx->getDeclForMangledName(F.getName());
-    if (!Decl)
-      continue;
-    auto CanonicalFD = Decl->getCanonicalDecl()->getAsFunction();
-    auto DefItr{mVisibleToUser.find(CanonicalFD)};
-    if (DefItr == mVisibleToUser.end() ||
-        DefItr->second->Id != Request[msg::CalleeFuncList::FuncID])
-      continue;
+  if (auto *FE{findFunction(M, Request[msg::CalleeFuncList::FuncID])}) {
+    auto &F{*FE->F};
+    auto *CU{FE->CU};
+    auto *TfmCtx{FE->TfmCtx};
     if (F.isDeclaration())
       return ::json::Parser<msg::CalleeFuncList>::unparseAsObject(Request);
+    mRequested.try_emplace(&F, mRequested.size());
     msg::CalleeFuncList StmtList = Request;
     auto &SrcMgr = TfmCtx->getContext().getSourceManager();
-    auto &Provider = getAnalysis<ServerPrivateProvider>(F);
-    auto &Matcher = Provider.get<LoopMatcherPass>().getMatcher();
-    auto &Unmatcher = Provider.get<LoopMatcherPass>().getUnmatchedAST();
+    auto &Provider = getProvider(F);
     auto &FuncInfo = Provider.get<ClangCFTraitsPass>().getFuncInfo();
     auto &CFLoopInfo = Provider.get<ClangCFTraitsPass>().getLoopInfo();
     const ClangCFTraitsPass::RegionCFInfo *Info = nullptr;
     if (StmtList[msg::CalleeFuncList::LoopID]) {
-      bcl::tagged_pair<
-        bcl::tagged<clang::Stmt *, AST>,
-        bcl::tagged<Loop *, IR>> Loop(nullptr, nullptr);
-      for (auto Match : Matcher)
-        if (auto Id{toId(&M, CU, Match.get<AST>()->getBeginLoc())};
-            Id && *Id == StmtList[msg::CalleeFuncList::LoopID]) {
-          Loop = Match;
-          break;
-        }
-      if (!Loop.get<AST>()) {
-        for (auto Unmatch : Unmatcher)
-          if (auto Id{toId(&M, CU, Unmatch->getBeginLoc())};
-              Id && *Id == StmtList[msg::CalleeFuncList::LoopID]) {
-            Loop.get<AST>() = Unmatch;
-            break;
-          }
-      }
+      auto Loop{findLoop(M, *FE, Provider.get<LoopMatcherPass>(),
+                         StmtList[msg::CalleeFuncList::LoopID])};
       if (!Loop.get<AST>())
         return ::json::Parser<msg::CalleeFuncList>::unparseAsObject(Request);
       auto I = CFLoopInfo.find(Loop.get<AST>());
@@ -1533,44 +1969,28 @@ std::string PrivateServerPass::answerCalleeFuncList(llvm::Module &M,
 
 std::string PrivateServerPass::answerAliasTree(llvm::Module &Module,
   const msg::AliasTree &Request) {
-  for (Function &F : Module) {
-    auto *DISub{findMetadata(&F)};
-    if (!DISub)
-      continue;
-    auto *CU{DISub->getUnit()};
-    auto *TfmCtx{dyn_cast_or_null<ClangTransformationContext>(
-        mTfmInfo->getContext(*CU))};
-    if (!TfmCtx || !TfmCtx->hasInstance())
-      continue;
-    auto Decl = TfmCtx->getDeclForMangledName(F.getName());
-    if (!Decl)
-      continue;
-    auto CanonicalFD = Decl->getCanonicalDecl()->getAsFunction();
-    auto DefItr{mVisibleToUser.find(CanonicalFD)};
-    if (DefItr == mVisibleToUser.end() ||
-        DefItr->second->Id != Request[msg::AliasTree::FuncID])
-      continue;
+  if (auto *FE{findFunction(Module, Request[msg::AliasTree::FuncID])}) {
+    auto &F{*FE->F};
+    auto *CU{FE->CU};
+    auto *TfmCtx{FE->TfmCtx};
     if (F.isDeclaration())
       return ::json::Parser<msg::AliasTree>::unparseAsObject(Request);
+    mRequested.try_emplace(&F, mRequested.size());
     auto &SrcMgr = TfmCtx->getContext().getSourceManager();
-    auto &Provider = getAnalysis<ServerPrivateProvider>(F);
-    auto &LoopMatcher = Provider.get<LoopMatcherPass>().getMatcher();
+    auto &Provider = getProvider(F);
     auto &MemoryMatcher = Provider.get<ClangDIMemoryMatcherPass>().getMatcher();
     if (Request[msg::AliasTree::LoopID]) {
-      bcl::tagged_pair<
-        bcl::tagged<clang::Stmt *, AST>,
-        bcl::tagged<Loop *, IR>> Loop(nullptr, nullptr);
-      for (auto Match : LoopMatcher)
-        if (auto Id{toId(&Module, CU, Match.get<AST>()->getBeginLoc())};
-            Id && *Id == Request[msg::AliasTree::LoopID]) {
-          Loop = Match;
-          break;
-        }
-      if (!Loop.get<AST>() || !Loop.get<IR>()->getLoopID())
+      auto Loop{findLoop(Module, *FE, Provider.get<LoopMatcherPass>(),
+                         Request[msg::AliasTree::LoopID])};
+      if (!Loop.get<IR>() || !Loop.get<IR>()->getLoopID())
         return ::json::Parser<msg::AliasTree>::unparseAsObject(Request);
+      if (isCancelled())
+        return answerCancelled();
       auto RF = mSocket->getAnalysis<
         DIEstimateMemoryPass, DIDependencyAnalysisPass>(F);
       assert(RF && "Dependence analysis must be available!");
+      if (isCancelled())
+        return answerCancelled();
       auto RM = mSocket->getAnalysis<
         AnalysisClientServerMatcherWrapper, ClonedDIMemoryMatcherWrapper>();
       assert(RM && "Client to server IR-matcher must be available!");
@@ -1591,12 +2011,58 @@ std::string PrivateServerPass::answerAliasTree(llvm::Module &Module,
       DenseSet<const DIAliasNode *> Coverage;
       accessCoverage<bcl::SimpleInserter>(DIDepSet, DIAT, Coverage,
                                           mGlobalOpts->IgnoreRedundantMemory);
-      msg::AliasTree Response;
-      Response[msg::AliasTree::FuncID] = Request[msg::AliasTree::FuncID];
-      Response[msg::AliasTree::LoopID] = Request[msg::AliasTree::LoopID];
-      for (auto &TS : DIDepSet) {
-        Response[msg::AliasTree::Nodes].emplace_back();
-        auto &N = Response[msg::AliasTree::Nodes].back();
+      // Collect nodes in breadth-first order within a specified depth.
+      std::vector<const DIAliasTrait *> Nodes;
+      for (auto &TS : DIDepSet)
+        if (Request[msg::AliasTree::Root]
+                ? reinterpret_cast<std::uintptr_t>(TS.getNode()) ==
+                      Request[msg::AliasTree::Root]
+                : !TS.getNode()->getParent() ||
+                      DIDepSet.find_as(TS.getNode()->getParent()) ==
+                          DIDepSet.end())
+          Nodes.push_back(&TS);
+      auto Depth{Request[msg::AliasTree::Depth]};
+      for (unsigned Level = 1, LevelBegin = 0;
+           LevelBegin < Nodes.size() && (!Depth || Level < Depth); ++Level) {
+        unsigned LevelEnd = Nodes.size();
+        for (auto I = LevelBegin; I < LevelEnd; ++I)
+          for (auto &C : make_range(Nodes[I]->getNode()->child_begin(),
+                                    Nodes[I]->getNode()->child_end()))
+            if (auto Itr{DIDepSet.find_as(&C)}; Itr != DIDepSet.end())
+              Nodes.push_back(&*Itr);
+        LevelBegin = LevelEnd;
+      }
+      std::size_t PageBegin{std::min<std::size_t>(
+          Request[msg::AliasTree::Offset], Nodes.size())};
+      std::size_t PageEnd{
+          Request[msg::AliasTree::Limit]
+              ? std::min(PageBegin + Request[msg::AliasTree::Limit],
+                         Nodes.size())
+              : Nodes.size()};
+      msg::AliasTree Response{Request};
+      Response[msg::AliasTree::Nodes].items().clear();
+      Response[msg::AliasTree::Edges].clear();
+      for (auto I = PageBegin; I < PageEnd; ++I) {
+        auto *Parent{Nodes[I]->getNode()};
+        for (auto &C : make_range(Parent->child_begin(), Parent->child_end()))
+          if (DIDepSet.find_as(&C) != DIDepSet.end())
+            Response[msg::AliasTree::Edges].emplace_back(
+                reinterpret_cast<std::uintptr_t>(Parent),
+                reinterpret_cast<std::uintptr_t>(&C), Parent->getKind());
+      }
+      // Description of memory locations may be huge, so nodes are not stored
+      // in the response. Each node is unparsed straight after it has been
+      // built.
+      bool IsCancelled{false};
+      Response[msg::AliasTree::Nodes].setGenerator([&, I = PageBegin](
+          msg::AliasNode &N) mutable {
+        if (I == PageEnd)
+          return false;
+        if (isCancelled()) {
+          IsCancelled = true;
+          return false;
+        }
+        auto &TS{*Nodes[I++]};
         N[msg::AliasNode::ID] = reinterpret_cast<std::uintptr_t>(TS.getNode());
         N[msg::AliasNode::Kind] = TS.getNode()->getKind();
         N[msg::AliasNode::Traits] = TS;
@@ -1689,15 +2155,10 @@ std::string PrivateServerPass::answerAliasTree(llvm::Module &Module,
           AddressOS.flush();
         }
         N[msg::AliasNode::Coverage] = Coverage.count(TS.getNode());
-        for (auto &C : make_range(TS.getNode()->child_begin(),
-                                  TS.getNode()->child_end())) {
-          if (DIDepSet.find_as(&C) == DIDepSet.end())
-            continue;
-          Response[msg::AliasTree::Edges].emplace_back(N[msg::AliasNode::ID],
-            reinterpret_cast<std::uintptr_t>(&C), N[msg::AliasNode::Kind]);
-        }
-      }
-      return ::json::Parser<msg::AliasTree>::unparseAsObject(Response);
+        return true;
+      });
+      auto JSON{::json::Parser<msg::AliasTree>::unparseAsObject(Response)};
+      return IsCancelled ? answerCancelled() : JSON;
     }
   }
   return ::json::Parser<msg::AliasTree>::unparseAsObject(Request);
@@ -1727,11 +2188,21 @@ bool PrivateServerPass::runOnModule(llvm::Module &M) {
                              ": transformation context is not available");
     return false;
   }
+  invalidateIndex();
+  mSummaries.clear();
+  mRequested.clear();
+  mBackground.clear();
+  mNextBackground = 0;
+  mIsBackgroundCollected = false;
+  mIsBackgroundScheduled = false;
+  mStopBackground = false;
   auto &SocketInfo = getAnalysis<AnalysisSocketImmutableWrapper>().get();
   mSocket = SocketInfo.getActiveSocket();
   assert(mSocket && "Active socket must be specified!");
   mGlobalsAA = &getAnalysis<GlobalsAAWrapperPass>().getResult();
   mGlobalOpts = &getAnalysis<GlobalOptionsImmutableWrapper>().getOptions();
+  auto &Changes = getAnalysis<FunctionChangeWrapper>();
+  mChanges = Changes ? &Changes.get() : nullptr;
   ServerPrivateProvider::initialize<TransformationEnginePass>(
     [this](TransformationEnginePass &TEP) {
       TEP.set(*mTfmInfo);
@@ -1767,6 +2238,8 @@ bool PrivateServerPass::runOnModule(llvm::Module &M) {
   if (GAP)
     ServerPrivateProvider::initialize<GlobalsAccessWrapper>(
         [&GAP](GlobalsAccessWrapper &Wrapper) { Wrapper.set(*GAP); });
+  mWorker = std::make_unique<ThreadPool>(hardware_concurrency(1));
+  scheduleBackground(M);
   while (mConnection->answer(
       [this, &M](const std::string &Request) -> std::string {
     msg::Diagnostic Diag(msg::Status::Error);
@@ -1774,27 +2247,146 @@ bool PrivateServerPass::runOnModule(llvm::Module &M) {
       Diag[msg::Diagnostic::Terminal] += mStdErr->diff();
       return ::json::Parser<msg::Diagnostic>::unparseAsObject(Diag);
     }
-    ::json::Parser<msg::Statistic, msg::FileList, msg::LoopTree,
-      msg::FunctionList, msg::CalleeFuncList, msg::AliasTree> P(Request);
-    auto Obj = P.parse();
-    assert(Obj && "Invalid request!");
-    if (Obj->is<msg::Statistic>())
-      return answerStatistic(M);
-    if (Obj->is<msg::FileList>())
-      return answerFileList();
-    if (Obj->is<msg::LoopTree>())
-      return answerLoopTree(M, Obj->as<msg::LoopTree>());
-    if (Obj->is<msg::FunctionList>())
-      return answerFunctionList(M);
-    if (Obj->is<msg::CalleeFuncList>())
-      return answerCalleeFuncList(M, Obj->as<msg::CalleeFuncList>());
-    if (Obj->is<msg::AliasTree>())
-      return answerAliasTree(M, Obj->as<msg::AliasTree>());
-    llvm_unreachable("Unknown request to server!");
+    ::json::Parser<msg::Submit, msg::Cancel, msg::Poll> P(Request);
+    if (auto Obj = P.parse()) {
+      if (Obj->is<msg::Submit>())
+        return answerSubmit(M, Obj->as<msg::Submit>());
+      if (Obj->is<msg::Cancel>())
+        return answerCancel(Obj->as<msg::Cancel>());
+      if (Obj->is<msg::Poll>())
+        return answerPoll(Obj->as<msg::Poll>());
+    }
+    // Synchronous request is placed to the same queue as asynchronous ones,
+    // so passes are never executed concurrently.
+    ++mQueuedRequests;
+    return mWorker
+        ->async([this, &M, &Request]() {
+          --mQueuedRequests;
+          auto Response{answer(M, Request)};
+          scheduleBackground(M);
+          return Response;
+        })
+        .get();
   }));
+  mStopBackground = true;
+  {
+    std::lock_guard<std::mutex> Lock(mAsyncMutex);
+    for (auto &R : mPending)
+      R.second->IsCancelled = true;
+  }
+  mWorker->wait();
+  mWorker.reset();
+  mPending.clear();
+  mReplies.clear();
   return false;
 }
 
+std::string PrivateServerPass::answer(llvm::Module &M,
+    const std::string &Request) {
+  ::json::Parser<msg::Statistic, msg::FileList, msg::LoopTree,
+    msg::FunctionList, msg::CalleeFuncList, msg::AliasTree> P(Request);
+  auto Obj = P.parse();
+  if (!Obj) {
+    msg::Diagnostic Diag(msg::Status::Error);
+    Diag.insert(msg::Diagnostic::Error, P.errors());
+    return ::json::Parser<msg::Diagnostic>::unparseAsObject(Diag);
+  }
+  if (Obj->is<msg::Statistic>())
+    return answerStatistic(M);
+  if (Obj->is<msg::FileList>())
+    return answerFileList();
+  if (Obj->is<msg::LoopTree>())
+    return answerLoopTree(M, Obj->as<msg::LoopTree>());
+  if (Obj->is<msg::FunctionList>())
+    return answerFunctionList(M);
+  if (Obj->is<msg::CalleeFuncList>())
+    return answerCalleeFuncList(M, Obj->as<msg::CalleeFuncList>());
+  if (Obj->is<msg::AliasTree>())
+    return answerAliasTree(M, Obj->as<msg::AliasTree>());
+  llvm_unreachable("Unknown request to server!");
+}
+
+std::string PrivateServerPass::answerSubmit(llvm::Module &M,
+    const msg::Submit &Request) {
+  msg::Diagnostic Diag(msg::Status::Error);
+  auto Id{Request[msg::Submit::ID]};
+  std::shared_ptr<AsyncRequest> R;
+  {
+    std::lock_guard<std::mutex> Lock(mAsyncMutex);
+    if (Id != 0 && !mPending.count(Id)) {
+      R = std::make_shared<AsyncRequest>(Id, Request[msg::Submit::Request]);
+      mPending.try_emplace(Id, R);
+    }
+  }
+  if (!R) {
+    Diag[msg::Diagnostic::Error].push_back(
+        "request identifier must be nonzero and unique");
+    return ::json::Parser<msg::Diagnostic>::unparseAsObject(Diag);
+  }
+  ++mQueuedRequests;
+  mWorker->async([this, &M, R]() {
+    --mQueuedRequests;
+    runAsync(M, R);
+    scheduleBackground(M);
+  });
+  Diag[msg::Diagnostic::Status] = msg::Status::Success;
+  return ::json::Parser<msg::Diagnostic>::unparseAsObject(Diag);
+}
+
+std::string PrivateServerPass::answerCancel(const msg::Cancel &Request) {
+  msg::Diagnostic Diag(msg::Status::Error);
+  std::lock_guard<std::mutex> Lock(mAsyncMutex);
+  auto I{mPending.find(Request[msg::Cancel::ID])};
+  if (I == mPending.end()) {
+    Diag[msg::Diagnostic::Error].push_back("unknown request identifier");
+    return ::json::Parser<msg::Diagnostic>::unparseAsObject(Diag);
+  }
+  I->second->IsCancelled = true;
+  Diag[msg::Diagnostic::Status] = msg::Status::Success;
+  return ::json::Parser<msg::Diagnostic>::unparseAsObject(Diag);
+}
+
+std::string PrivateServerPass::answerPoll(const msg::Poll &Request) {
+  std::unique_lock<std::mutex> Lock(mAsyncMutex);
+  if (Request[msg::Poll::Wait])
+    mAsyncReady.wait(Lock, [this]() {
+      return !mReplies.empty() || mPending.empty();
+    });
+  msg::Reply Reply;
+  if (!mReplies.empty()) {
+    Reply = std::move(mReplies.front());
+    mReplies.pop_front();
+  }
+  Reply[msg::Reply::Pending] = mPending.size();
+  return ::json::Parser<msg::Reply>::unparseAsObject(Reply);
+}
+
+void PrivateServerPass::runAsync(llvm::Module &M,
+    std::shared_ptr<AsyncRequest> Request) {
+  msg::Reply Reply;
+  Reply[msg::Reply::ID] = Request->Id;
+  if (!Request->IsCancelled) {
+    LLVM_DEBUG(dbgs() << "[SERVER]: process request " << Request->Id << "\n");
+    mActiveRequest = Request.get();
+    Reply[msg::Reply::Response] = answer(M, Request->Request);
+    mActiveRequest = nullptr;
+  }
+  if (Request->IsCancelled) {
+    LLVM_DEBUG(dbgs() << "[SERVER]: request " << Request->Id
+                      << " has been cancelled\n");
+    Reply[msg::Reply::Status] = msg::Status::Error;
+    Reply[msg::Reply::Response] = answerCancelled();
+  } else {
+    Reply[msg::Reply::Status] = msg::Status::Success;
+  }
+  {
+    std::lock_guard<std::mutex> Lock(mAsyncMutex);
+    mPending.erase(Request->Id);
+    mReplies.push_back(std::move(Reply));
+  }
+  mAsyncReady.notify_all();
+}
+
 void PrivateServerPass::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequired<AnalysisSocketImmutableWrapper>();
   AU.addRequired<ServerPrivateProvider>();
@@ -1804,6 +2396,7 @@ void PrivateServerPass::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequired<DIMemoryEnvironmentWrapper>();
   AU.addRequired<GlobalsAAWrapperPass>();
   AU.addRequired<GlobalsAccessWrapper>();
+  AU.addRequired<FunctionChangeWrapper>();
   AU.setPreservesAll();
 }
 
@@ -133,6 +133,10 @@ public:
     Passes.add(createDIMemoryTraitPoolStorage());
     Passes.add(createDIMemoryEnvironmentStorage());
     Passes.add(createGlobalsAccessStorage());
+    // Versions of functions allow the server to reuse results of analysis
+    // of the same function for different requests.
+    Passes.add(createFunctionChangeStorage());
+    Passes.add(createFunctionChangeTracker());
     Passes.add(createGlobalsAccessCollector());
     Passes.add(createDIEstimateMemoryPass());
     Passes.add(createDIMemoryAnalysisServer());